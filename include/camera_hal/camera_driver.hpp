@@ -39,6 +39,18 @@ namespace CameraHAL
          */
         virtual bool read(cv::Mat &image) = 0;
 
+        /**
+         * @brief 暂停取流，保留相机配置和AE/AWB状态
+         * @return 是否成功
+         */
+        virtual bool suspend() = 0;
+
+        /**
+         * @brief 恢复取流
+         * @return 是否成功
+         */
+        virtual bool resume() = 0;
+
         /**
          * @brief 关闭相机
          * @return 是否成功
@@ -28,6 +28,8 @@ namespace CameraHAL
         bool open(std::unordered_map<std::string, std::string> &params) override;
         bool write(std::string para_name, std::string para_value) override;
         bool read(cv::Mat &image) override;
+        bool suspend() override;
+        bool resume() override;
         bool close() override;
     };
 } // namespace CameraHAL
@@ -3,12 +3,23 @@
 
 #include <memory>
 #include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include <opencv2/opencv.hpp>
 #include <camera_hal/camera_driver.hpp>
 #include <chrono>
+#include "frame_queue.hpp"
+#include "load_shedder.hpp"
+#include "roi_rectifier.hpp"
+#include <level_detector/level_detector.hpp>
 
 /**
  * @brief 相机管理器类，负责相机操作和液位检测
+ * @note 采集、预处理（ROI标定）、检测、快照写盘分别运行在独立线程，
+ *       各级之间通过容量为1的latest-wins队列交接，检测总是处理最新帧
  */
 class CameraManager {
 public:
@@ -48,20 +59,220 @@ public:
     double getLiquidLevelPercentage() const;
     
     /**
-     * @brief 相机线程是否正在运行
+     * @brief 相机处理流水线是否正在运行
      * @return 是否正在运行
      */
     bool isRunning() const;
+
+    /**
+     * @brief 设置液位采样间隔
+     * @param interval 采样间隔，不小于 dutyCycleThreshold_ 时相机在两次采样之间停止取流
+     */
+    void setSampleInterval(std::chrono::milliseconds interval);
+
+    /**
+     * @brief 相机占空比统计，用于对比开启/关闭占空比时的CPU与功耗
+     */
+    struct DutyCycleStats
+    {
+        bool duty_cycling = false;      // 当前是否处于占空比模式
+        double streaming_ratio = 1.0;   // 取流时间占比
+        double cpu_usage = 0.0;         // 进程平均CPU占用（单核百分比）
+        uint64_t wakeups = 0;           // 恢复取流次数
+        double avg_wake_latency_ms = 0; // 恢复取流到首个有效帧的平均耗时
+    };
+
+    /**
+     * @brief 获取占空比统计（自启动处理线程起累计）
+     * @return 统计数据
+     */
+    DutyCycleStats getDutyCycleStats() const;
+
+    /**
+     * @brief 流水线单级统计
+     */
+    struct StageStats
+    {
+        std::string name;
+        size_t queue_depth = 0;     // 输入队列当前深度
+        uint64_t processed = 0;     // 已处理帧数
+        uint64_t dropped = 0;       // 输入队列因latest-wins丢弃的帧数
+        double latency_ms = 0;      // 本级处理耗时（滑动平均）
+        double wait_ms = 0;         // 输入队列等待时间（滑动平均）
+        double frame_age_ms = 0;    // 帧从采集到本级完成的时延（滑动平均）
+    };
+
+    /**
+     * @brief 获取各级流水线统计
+     * @return 按采集、预处理、检测、快照顺序排列的统计数据
+     */
+    std::vector<StageStats> getPipelineStats() const;
+
+    /**
+     * @brief 加载相机安装标定（镜头畸变与瓶体平面透视），需在startProcessing之前调用
+     * @param path cv::FileStorage格式的标定文件
+     * @return 是否加载成功
+     */
+    bool loadCameraCalibration(const std::string &path);
+
+    /**
+     * @brief ROI矫正映射表重建次数
+     */
+    uint64_t getRoiMapRebuilds() const { return rectifier_.rebuildCount(); }
+
+    /**
+     * @brief 设置检测单帧处理耗时预算，超出时逐级降级
+     * @param budget 预算
+     */
+    void setProcessingBudget(std::chrono::milliseconds budget);
+
+    /**
+     * @brief 获取负载降级控制器（模式与跳过帧数）
+     */
+    const LoadShedder &getLoadShedder() const { return loadShedder_; }
+
+    /**
+     * @brief 选择液位检测策略，需在startProcessing之前调用
+     * @param primary 主检测策略名称
+     * @param shadow 影子检测策略名称，为空时不启用影子模式
+     * @param shadowEvery 每隔多少帧抽样一帧交给影子检测
+     * @return 策略名称是否有效
+     */
+    bool setDetectorStrategy(const std::string &primary, const std::string &shadow = "", int shadowEvery = 10);
+
+    /**
+     * @brief 检测策略统计（影子模式对比）
+     */
+    struct DetectorStats
+    {
+        std::string primary;
+        std::string shadow;
+        uint64_t shadow_samples = 0;     // 影子检测抽样帧数
+        uint64_t shadow_failures = 0;    // 主检测成功而影子检测失败的帧数
+        double primary_latency_ms = 0;   // 抽样帧上主检测平均耗时
+        double shadow_latency_ms = 0;    // 影子检测平均耗时
+        double mean_disagreement = 0;    // 两者液位平均绝对差（百分点）
+        double max_disagreement = 0;     // 两者液位最大绝对差（百分点）
+    };
+
+    /**
+     * @brief 获取检测策略统计
+     */
+    DetectorStats getDetectorStats() const;
+
+    /**
+     * @brief 获取主检测策略的液位线跟踪统计（不含影子检测）
+     */
+    LevelDetectionStats getLevelDetectionStats() const;
+
+    /**
+     * @brief 液位回调
+     * @param raw 本帧检测的原始液位 (%)
+     * @param filtered 滤波后的液位 (%)
+     * @param captured 帧采集时间
+     */
+    using LevelCallback = std::function<void(double raw, double filtered, std::chrono::steady_clock::time_point captured)>;
+
+    /**
+     * @brief 设置液位回调，在检测线程中每次检测成功后调用，需在startProcessing之前设置
+     * @param callback 回调函数
+     */
+    void setLevelCallback(LevelCallback callback) { levelCallback_ = std::move(callback); }
     
 private:
+    // 流水线级
+    enum PipelineStage
+    {
+        STAGE_CAPTURE = 0,
+        STAGE_PREPROCESS,
+        STAGE_DETECT,
+        STAGE_SNAPSHOT,
+        STAGE_COUNT
+    };
+
+    // 级间传递的帧
+    struct PipelineFrame
+    {
+        cv::Mat image;
+        std::chrono::steady_clock::time_point captured;
+        std::chrono::steady_clock::time_point enqueued;
+        cv::Rect2d ispCrop{0, 0, 1, 1}; // 本帧对应的视场（相对全视场）
+        cv::Rect2d cpuRoi{0, 0, 1, 1};  // 需在CPU上裁剪的区域（相对本帧，矫正后为全图）
+        double level = -1.0;            // 主检测的原始液位
+        double detectMs = 0.0;          // 主检测耗时
+    };
+
+    // 单级计数器，只由本级线程写入
+    struct StageCounters
+    {
+        std::atomic<uint64_t> processed{0};
+        std::atomic<double> latencyMs{0.0};
+        std::atomic<double> waitMs{0.0};
+        std::atomic<double> frameAgeMs{0.0};
+    };
+
     std::shared_ptr<CameraHAL::CameraDriver> camera_driver_;
     std::atomic<bool> camera_thread_running_{false};
     std::atomic<double> liquid_level_percentage_{-1.0};
-    // ROI坐标（相对比例）
+    // 采样间隔（毫秒）
+    std::atomic<int64_t> sampleIntervalMs_{100};
+    // 采样间隔达到该值时启用占空比（取流启动约需数百毫秒）
+    const std::chrono::milliseconds dutyCycleThreshold_{2000};
+    // 恢复取流后丢弃的帧数，AE/AWB状态保留，只需极少帧即可收敛
+    const int warmupFrames_ = 2;
+    // 占空比统计
+    std::atomic<bool> suspended_{false};
+    std::atomic<int64_t> streamingNs_{0};
+    std::atomic<int64_t> streamStartNs_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<int64_t> wakeLatencyNs_{0};
+    std::chrono::steady_clock::time_point processingStart_;
+    double processingStartCpu_ = 0.0;
+    // ROI坐标（相对比例），仅由预处理线程访问
     double startHeight_ = 0.0, startWidth_ = 0.0, endHeight_ = 1.0, endWidth_ = 1.0;
+    // 旋转由ISP完成；否则由ROI矫正映射表完成
+    bool ispTransform_ = false;
+    // ROI矫正（畸变+透视+裁剪），仅由预处理线程使用
+    RoiRectifier rectifier_;
+    // ISP裁剪(ScalerCrop)：预处理线程请求，采集线程下发
+    std::mutex cropMutex_;
+    bool cropPending_ = false;
+    cv::Rect2d requestedCrop_{0, 0, 1, 1};
+    cv::Rect2d lastRequestedCrop_{0, 0, 1, 1}; // 最近一次请求的裁剪，下发失败时置为无效值
+    cv::Rect2d ispCrop_{0, 0, 1, 1};
+    // 更改裁剪后丢弃的帧数（请求队列深度）
+    const int cropSettleFrames_ = 5;
     // 标定间隔（毫秒），默认5分钟
     const std::chrono::milliseconds calibrationInterval_{300000};
     std::chrono::steady_clock::time_point lastCalibration_;
+
+    // 流水线线程与级间队列
+    std::vector<std::thread> stageThreads_;
+    FrameQueue<PipelineFrame> preprocessQueue_{1};
+    FrameQueue<PipelineFrame> detectQueue_{1};
+    FrameQueue<PipelineFrame> snapshotQueue_{1};
+    FrameQueue<PipelineFrame> shadowQueue_{1};
+    StageCounters stageCounters_[STAGE_COUNT];
+
+    // 负载降级：降分辨率时的检测缩放，降帧率时的采样间隔倍数
+    LoadShedder loadShedder_;
+    const double reducedDetectionScale_ = 0.5;
+    const int reducedFpsDivider_ = 4;
+
+    // 液位检测策略；影子策略在低优先级线程中对抽样帧运行，只记录对比结果
+    std::unique_ptr<LevelDetector::Detector> detector_;
+    std::unique_ptr<LevelDetector::Detector> shadowDetector_;
+    LevelDetector::LevelFilter levelFilter_;
+    LevelCallback levelCallback_;
+    int shadowEvery_ = 10;
+    uint64_t detectedFrames_ = 0;
+    std::atomic<uint64_t> shadowSamples_{0};
+    std::atomic<uint64_t> shadowFailures_{0};
+    std::atomic<uint64_t> shadowCompared_{0};
+    std::atomic<double> shadowPrimaryMsSum_{0.0};
+    std::atomic<double> shadowMsSum_{0.0};
+    std::atomic<double> disagreementSum_{0.0};
+    std::atomic<double> disagreementMax_{0.0};
   
     /**
      * @brief 执行ROI自动标定
@@ -70,9 +281,52 @@ private:
     void calibrateROI(const cv::Mat& frame);
 
     /**
-     * @brief 相机处理线程
+     * @brief 将标定的ROI下发给ISP裁剪，不支持时交给检测器在CPU上裁剪
+     */
+    void applyRoi();
+
+    /**
+     * @brief 请求采集线程更改ISP裁剪
+     * @param crop 裁剪区域（相对全视场）
+     */
+    void requestCrop(const cv::Rect2d& crop);
+
+    /**
+     * @brief 记录单级处理统计
+     */
+    void recordStage(PipelineStage stage, const PipelineFrame& frame,
+                     std::chrono::steady_clock::time_point start);
+
+    /**
+     * @brief 采集线程：取流、占空比与ISP裁剪下发
+     */
+    void captureThread();
+
+    /**
+     * @brief 预处理线程：ROI标定与CPU裁剪区域计算
+     */
+    void preprocessThread();
+
+    /**
+     * @brief 检测线程：液位检测
+     */
+    void detectThread();
+
+    /**
+     * @brief 快照线程：检测结果写盘
+     */
+    void snapshotThread();
+
+    /**
+     * @brief 影子检测线程：对抽样帧运行候选策略并与主策略对比
+     */
+    void shadowThread();
+
+    /**
+     * @brief 可中断的等待，处理线程停止时提前返回
+     * @param duration 等待时长
      */
-    void cameraThread();
+    void sleepFor(std::chrono::steady_clock::duration duration);
 };
 
 #endif // CAMERA_MANAGER_HPP
@@ -0,0 +1,120 @@
+#ifndef FLOW_MONITOR_HPP
+#define FLOW_MONITOR_HPP
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "regression_sums.hpp"
+
+/**
+ * @brief 流量一致性监测：比较液位下降速度与指令流量，检测堵塞与自由流
+ * @note 在固定时长的滑动窗口上维护液位-时间回归的累加量，样本进出窗口均为O(1)更新；
+ *       实测流量与指令流量的偏差超过容差与统计误差之和并持续一段时间后报警
+ */
+class FlowMonitor
+{
+public:
+    /**
+     * @brief 报警类型
+     */
+    enum Alarm
+    {
+        NONE = 0,
+        OCCLUSION, // 实测流量明显低于指令流量（管路堵塞、泵管脱出）
+        FREE_FLOW  // 实测流量明显高于指令流量（自由流）
+    };
+
+    /**
+     * @brief 监测状态
+     */
+    struct Status
+    {
+        bool valid = false;          // 窗口样本足够
+        Alarm alarm = NONE;          // 已确认的报警（锁存至reset）
+        double measured_flow = 0.0;  // 液位下降折算流量 (ml/h)
+        double commanded_flow = 0.0; // 窗口内平均指令流量 (ml/h)
+        double flow_stderr = 0.0;    // 实测流量标准误差 (ml/h)
+        int samples = 0;             // 窗口内样本数
+        std::chrono::steady_clock::time_point updated; // 最新样本时间
+    };
+
+    /**
+     * @brief 构造函数
+     * @param window 滑动窗口时长
+     */
+    explicit FlowMonitor(std::chrono::seconds window = std::chrono::seconds(90));
+
+    /**
+     * @brief 添加样本
+     * @param level 剩余液位 (0-100%)
+     * @param commandedFlow 采样时的指令流量 (ml/h)，电机停止时为0
+     * @param bottleVolume 药瓶容量 (ml)
+     * @param time 采样时间
+     * @return 本次样本后确认的报警（已锁存时返回锁存的报警）
+     */
+    Alarm addSample(double level, double commandedFlow, double bottleVolume,
+                    std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief 获取当前状态
+     */
+    Status getStatus() const;
+
+    /**
+     * @brief 已确认的报警
+     */
+    Alarm getAlarm() const;
+
+    /**
+     * @brief 清空窗口与报警（开始新的输液或报警处理完毕后）
+     */
+    void reset();
+
+    /**
+     * @brief 报警名称
+     */
+    static const char *alarmName(Alarm alarm);
+
+private:
+    struct Sample
+    {
+        double t;         // 相对origin_的时间 (s)
+        double volume;    // 剩余容量 (ml)
+        double commanded; // 指令流量 (ml/h)
+    };
+
+    // 重新计算累加量，清除浮点累积误差；每capacity个样本一次，均摊O(1)
+    void rebuildSums();
+    void push(const Sample &sample);
+    void popFront();
+    Status evaluate() const;
+
+    mutable std::mutex mutex_;
+    const double window_;      // 窗口时长 (s)
+    std::vector<Sample> ring_; // 环形缓冲，容量固定
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t sinceRebuild_ = 0;
+    bool hasOrigin_ = false;
+    std::chrono::steady_clock::time_point origin_;
+
+    // 窗口累加量：容量-时间回归与Σcommanded
+    RegressionSums sums_;
+    double sc_ = 0.0;
+
+    // 偏差持续计时
+    Alarm pending_ = NONE;
+    double pendingSince_ = 0.0;
+    Alarm alarm_ = NONE;
+
+    static constexpr size_t capacity_ = 2048;     // 10Hz采样下覆盖约200秒
+    static constexpr int minSamples_ = 20;
+    static constexpr double minSpanRatio_ = 0.75; // 样本跨度至少为窗口的75%才判定
+    static constexpr double relTolerance_ = 0.5;  // 相对指令流量的容差
+    static constexpr double absTolerance_ = 3.0;  // 绝对容差 (ml/h)
+    static constexpr double z_ = 3.0;             // 统计误差倍数
+    static constexpr double confirmTime_ = 10.0;  // 偏差持续时间 (s)
+    static constexpr double restartRatio_ = 0.2;  // 指令流量变化超过该比例时重新开窗
+};
+
+#endif // FLOW_MONITOR_HPP
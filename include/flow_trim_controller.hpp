@@ -0,0 +1,82 @@
+#ifndef FLOW_TRIM_CONTROLLER_HPP
+#define FLOW_TRIM_CONTROLLER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 流量闭环修正：按视觉实测流量修正开环转速
+ * @note 输出为转速修正系数，目标转速 = 开环转速 × (1 + trim)。
+ *       积分控制（增量形式），修正量有上限且每步变化受限；
+ *       修正量本身即积分状态，限幅时不再累积，不会积分饱和。
+ *       实测数据过期或无效时回退到开环
+ */
+class FlowTrimController
+{
+public:
+    /**
+     * @brief 控制器统计
+     */
+    struct Stats
+    {
+        double trim = 0.0;           // 当前修正系数
+        double flow_error = 0.0;     // 最近一次相对流量误差 (实测-目标)/目标
+        bool closed_loop = false;    // 是否处于闭环
+        uint64_t updates = 0;        // 修正步数
+        uint64_t saturated = 0;      // 因限幅被截断的步数
+        uint64_t stale_fallbacks = 0; // 因实测过期回退开环的次数
+    };
+
+    FlowTrimController() = default;
+
+    /**
+     * @brief 控制一步，由周期线程调用
+     * @param targetFlow 目标流量 (ml/h)
+     * @param measuredFlow 实测流量 (ml/h)
+     * @param measurementValid 实测是否有效
+     * @param measuredAt 实测最新样本时间
+     * @param now 当前时间
+     * @return 修正系数trim
+     */
+    double update(double targetFlow, double measuredFlow, bool measurementValid,
+                  std::chrono::steady_clock::time_point measuredAt,
+                  std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 当前修正系数
+     */
+    double getTrim() const { return trim_.load(); }
+
+    /**
+     * @brief 获取统计
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief 回到开环并清空修正（停止输液或更改目标流量时）
+     */
+    void reset();
+
+private:
+    void fallback();
+
+    std::atomic<double> trim_{0.0};
+    std::atomic<double> lastError_{0.0};
+    std::atomic<bool> closedLoop_{false};
+    std::atomic<uint64_t> updates_{0};
+    std::atomic<uint64_t> saturated_{0};
+    std::atomic<uint64_t> staleFallbacks_{0};
+
+    double lastTarget_ = 0.0;
+    bool hasStep_ = false;
+    std::chrono::steady_clock::time_point lastStep_;
+
+    static constexpr double maxTrim_ = 0.25;    // 修正上限 ±25%
+    static constexpr double maxStep_ = 0.01;    // 每步修正变化上限
+    static constexpr double gain_ = 0.05;       // 积分增益（每步），实测窗口约90秒，增益过大会放大噪声
+    static constexpr double interval_ = 10.0;   // 修正周期 (s)
+    static constexpr double staleAfter_ = 15.0; // 实测超过该时长未更新视为过期 (s)
+};
+
+#endif // FLOW_TRIM_CONTROLLER_HPP
@@ -0,0 +1,126 @@
+#ifndef FRAME_QUEUE_HPP
+#define FRAME_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 有界单生产者/单消费者队列，队满时丢弃最旧元素（latest-wins）
+ * @note 用于视觉流水线各级之间的交接，保证下游总是处理最新的帧而不会积压
+ */
+template <typename T>
+class FrameQueue
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 队列容量
+     */
+    explicit FrameQueue(size_t capacity = 1) : slots_(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief 入队，队满时覆盖最旧的元素
+     * @param item 元素
+     * @return 是否丢弃了旧元素
+     */
+    bool push(T item)
+    {
+        bool dropped = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == slots_.size())
+            {
+                head_ = (head_ + 1) % slots_.size();
+                count_--;
+                dropped = true;
+                dropped_++;
+            }
+            slots_[(head_ + count_) % slots_.size()] = std::move(item);
+            count_++;
+        }
+        cond_.notify_one();
+        return dropped;
+    }
+
+    /**
+     * @brief 出队
+     * @param item 输出元素
+     * @param timeout 超时时间
+     * @return 是否取到元素（超时或已关闭返回false）
+     */
+    bool pop(T &item, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cond_.wait_for(lock, timeout, [this]
+                            { return count_ > 0 || closed_; }) ||
+            count_ == 0)
+        {
+            return false;
+        }
+        item = std::move(slots_[head_]);
+        slots_[head_] = T();
+        head_ = (head_ + 1) % slots_.size();
+        count_--;
+        return true;
+    }
+
+    /**
+     * @brief 关闭队列，唤醒等待的消费者
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cond_.notify_all();
+    }
+
+    /**
+     * @brief 重新打开并清空队列
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &slot : slots_)
+        {
+            slot = T();
+        }
+        head_ = 0;
+        count_ = 0;
+        closed_ = false;
+    }
+
+    /**
+     * @brief 当前队列深度
+     */
+    size_t depth() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    /**
+     * @brief 因latest-wins被丢弃的元素数
+     */
+    uint64_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool closed_ = false;
+    uint64_t dropped_ = 0;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+};
+
+#endif // FRAME_QUEUE_HPP
@@ -11,6 +11,10 @@
 #include "pump_common.hpp"
 #include "pump_database.hpp"
 #include "infusion_state_machine.hpp"
+#include "remaining_time_estimator.hpp"
+#include "flow_monitor.hpp"
+#include "flow_trim_controller.hpp"
+#include "pump_calibrator.hpp"
 #include "sound_effect_manager.hpp"
 
 /**
@@ -70,6 +74,62 @@ public:
      */
     void handleSignal(int signum);
 
+    /**
+     * @brief 设置液位采样间隔，需在initialize之前调用
+     * @param intervalMs 采样间隔（毫秒）
+     */
+    void setCameraSampleInterval(int intervalMs);
+
+    /**
+     * @brief 设置液位检测单帧耗时预算，需在initialize之前调用
+     * @param budgetMs 预算（毫秒）
+     */
+    void setVisionBudget(int budgetMs);
+
+    /**
+     * @brief 设置液位检测策略，需在initialize之前调用
+     * @param primary 主检测策略
+     * @param shadow 影子检测策略，为空时不启用
+     * @param shadowEvery 影子检测抽样间隔（帧）
+     */
+    void setDetectorStrategy(const std::string &primary, const std::string &shadow, int shadowEvery);
+
+    /**
+     * @brief 设置相机安装标定文件，需在initialize之前调用
+     * @param path 标定文件路径，为空时不做畸变与透视校正
+     */
+    void setCameraCalibration(const std::string &path);
+
+    /**
+     * @brief 启用或关闭流量闭环修正，需在start之前调用
+     * @param enabled 是否启用，关闭时始终按开环转速运行
+     */
+    void setFlowTrim(bool enabled);
+
+    /**
+     * @brief 设置电机控制线程的实时配置，需在start之前调用
+     * @param profile 调度优先级、CPU绑定等，enabled为false时按普通线程运行
+     */
+    void setRealtimeProfile(const MotorDriver::RealtimeProfile &profile);
+
+    /**
+     * @brief 选择电机后端，需在initialize之前调用
+     * @param name "gpiod"（默认，pwm_beeper产生脉冲）、"sysfs"（内核PWM类产生脉冲）或 "sim"（仿真，不访问硬件）
+     */
+    void setMotorBackend(const std::string &name);
+
+    /**
+     * @brief 设置sysfs后端使用的PWM通道，需在initialize之前调用
+     * @param chipPath PWM芯片目录，如 /sys/class/pwm/pwmchip0
+     * @param channel 通道号
+     */
+    void setPwmChannel(const std::string &chipPath, int channel);
+
+    /**
+     * @brief 启用或关闭按泵脉动剖面调制步频的脉动补偿，需在initialize之前调用
+     */
+    void setPulsationCompensation(bool enabled);
+
 private:
     // MQTT配置
     const std::string SERVER_ADDRESS = "mqtt://tb.chenyuwuai.xyz:1883";
@@ -87,6 +147,35 @@ private:
     // 液位传感百分比
     std::atomic<double> liquid_level_percentage_{-1.0};
 
+    // 剩余时间估计（输液期间由相机检测线程喂入液位样本）
+    RemainingTimeEstimator remainingTimeEstimator_;
+
+    // 流量一致性监测（液位下降速度与指令流量比较）
+    FlowMonitor flowMonitor_;
+
+    // 流量闭环修正
+    FlowTrimController flowTrim_;
+    bool flowTrimEnabled_ = true;
+
+    // 电机控制线程实时配置
+    MotorDriver::RealtimeProfile realtimeProfile_;
+
+    // 电机后端
+    std::string motorBackendName_ = "gpiod";
+    std::string pwmChipPath_ = "/sys/class/pwm/pwmchip0";
+    int pwmChannel_ = 3; // RP1 PWM0通道3对应GPIO19，即原pwm_beeper的引脚
+
+    // 脉动补偿
+    bool pulsationCompensation_ = false;
+
+    // 液位采样间隔（毫秒）
+    int cameraSampleIntervalMs_ = 100;
+    int visionBudgetMs_ = 50;
+    std::string detectorName_ = "hough";
+    std::string shadowDetectorName_;
+    int shadowEvery_ = 10;
+    std::string cameraCalibFile_;
+
     // 电机控制参数
     const char* GPIO_CHIPNAME = "gpiochip4";
     const int DIR_PIN = 27;
@@ -101,10 +190,12 @@ private:
     std::unique_ptr<MotorDriver> motorDriver_;
     std::unique_ptr<MQTTThreadManager> mqttThreadManager_;
     std::unique_ptr<InfusionStateMachine> stateMachine_;
+    std::unique_ptr<PumpCalibrator> pumpCalibrator_;
     
     // 泵数据库和名称
     std::unique_ptr<PumpDatabase> pumpDatabase_;
     std::string pumpName_;
+    const PumpHandle *pump_ = nullptr; // pumpName_对应的句柄，标定线程更新时原子替换快照
     std::string pumpDataFile_;
     
     /**
@@ -130,6 +221,17 @@ private:
      */
     bool initializeStateMachine();
 
+    /**
+     * @brief 由电机当前转速和泵数据计算指令流量
+     * @return 指令流量（ml/h），电机停止或泵数据不可用时为0
+     */
+    double commandedFlowRate();
+
+    /**
+     * @brief 按实测流量修正目标转速，由主循环周期调用
+     */
+    void updateFlowTrim();
+
     void playShutdownSound();
 };
 
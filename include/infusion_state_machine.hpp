@@ -4,6 +4,8 @@
 #include "openfsm.h"
 #include "pump_common.hpp"
 #include "motor_driver.hpp"
+#include "remaining_time_estimator.hpp"
+#include "flow_monitor.hpp"
 #include <memory>
 #include <nlohmann/json.hpp>
 #include "pn532.h"
@@ -62,12 +64,26 @@ public:
      */
     bool isValidStateTransition(PumpControlState from, PumpControlState to) const;
 
+    /**
+     * @brief 设置剩余时间估计器，输液状态下用于计算剩余时间
+     * @param estimator 估计器指针
+     */
+    void setRemainingTimeEstimator(RemainingTimeEstimator *estimator);
+
+    /**
+     * @brief 设置流量监测器，输液与暂停状态下检查堵塞与自由流
+     * @param monitor 监测器指针
+     */
+    void setFlowMonitor(FlowMonitor *monitor);
+
     // 状态机自定义数据结构 - 必须公开以便Action类访问
     struct FSMContext
     {
         MotorDriver *motorDriver;
         PumpParams *pumpParams;
         PumpState *pumpState;
+        RemainingTimeEstimator *remainingTimeEstimator{nullptr};
+        FlowMonitor *flowMonitor{nullptr};
 
         // 状态转换相关计时器（毫秒）
         int preparingTimer{0};
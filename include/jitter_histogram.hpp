@@ -0,0 +1,56 @@
+#ifndef JITTER_HISTOGRAM_HPP
+#define JITTER_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 定时抖动直方图：按固定的对数分桶统计微秒级时延
+ * @note record只做原子累加，不加锁、不分配内存，可在实时线程中调用；读取端取快照
+ */
+class JitterHistogram
+{
+public:
+    static constexpr int bucketCount = 12;
+
+    /**
+     * @brief 直方图快照
+     */
+    struct Snapshot
+    {
+        std::array<uint64_t, bucketCount> counts{}; // 各桶计数，桶上界见bucketUpperBound
+        uint64_t samples = 0;
+        double mean_us = 0.0;
+        double max_us = 0.0;
+    };
+
+    /**
+     * @brief 记录一个样本
+     * @param us 时延（微秒），负值按0计
+     */
+    void record(double us);
+
+    /**
+     * @brief 获取快照
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief 清空
+     */
+    void reset();
+
+    /**
+     * @brief 第i个桶的上界（微秒），最后一个桶无上界，返回-1
+     */
+    static double bucketUpperBound(int i);
+
+private:
+    std::array<std::atomic<uint64_t>, bucketCount> counts_{};
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint64_t> sumNs_{0};
+    std::atomic<uint64_t> maxNs_{0};
+};
+
+#endif // JITTER_HISTOGRAM_HPP
@@ -0,0 +1,65 @@
+/**
+ * @file cnn_detector.hpp
+ * @note 基于int8量化小型CNN的液位线回归检测（OpenCV DNN，CPU后端）
+ */
+#ifndef CNN_DETECTOR_HPP
+#define CNN_DETECTOR_HPP
+
+#include <level_detector/level_detector.hpp>
+#include <opencv2/dnn.hpp>
+#include <string>
+#include <vector>
+
+namespace LevelDetector
+{
+    /**
+     * @brief CNN液位线回归检测
+     * @note 模型约定：输入 N×1×128×64 灰度图（0-1归一化，量化/反量化节点在ONNX图内），
+     *       输出 N×1 为液位线所在行占ROI高度的比例（0-1，从顶部算起）；
+     *       若输出 N×2，第二列为置信度logit，低于0.5的结果视为失败。
+     *       输入blob按最大批量预分配，推理过程中不再分配输入内存
+     */
+    class CnnDetector : public Detector
+    {
+    public:
+        /**
+         * @brief 构造函数
+         * @param modelPath ONNX模型路径
+         * @param maxBatch 单次推理的最大ROI数
+         */
+        explicit CnnDetector(const std::string &modelPath, int maxBatch = 4);
+
+        /**
+         * @brief 模型是否加载成功
+         */
+        bool isLoaded() const { return loaded_; }
+
+        const char *name() const override { return "cnn"; }
+        Result detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated = nullptr) override;
+        std::vector<Result> detectBatch(const cv::Mat &image, const std::vector<cv::Rect2d> &rois) override;
+
+    private:
+        static constexpr int inputWidth_ = 64;
+        static constexpr int inputHeight_ = 128;
+        static constexpr double minConfidence_ = 0.5;
+
+        cv::dnn::Net net_;
+        bool loaded_ = false;
+        int maxBatch_;
+        cv::Mat blob_;                 ///< 预分配输入 maxBatch×1×H×W
+        cv::Mat cropped_, resized_, gray_; ///< 复用的中间缓冲
+        std::vector<cv::Mat> outputs_;
+
+        /**
+         * @brief 将一个ROI写入输入blob的第index个平面
+         */
+        bool fillInput(const cv::Mat &image, const cv::Rect2d &roi, int index);
+
+        /**
+         * @brief 对blob前count个平面推理
+         */
+        void infer(int count, std::vector<Result> &results);
+    };
+} // namespace LevelDetector
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file gradient_detector.hpp
+ * @note 基于行梯度剖面的液位检测
+ */
+#ifndef GRADIENT_DETECTOR_HPP
+#define GRADIENT_DETECTOR_HPP
+
+#include <level_detector/level_detector.hpp>
+
+namespace LevelDetector
+{
+    /**
+     * @brief 梯度剖面液位检测
+     * @note 对ROI求竖直方向梯度并按行平均，取平滑后响应最强的行作为液位线，
+     *       只做一次Sobel和一次行归约，开销远低于多次霍夫检测
+     */
+    class GradientDetector : public Detector
+    {
+    public:
+        const char *name() const override { return "gradient"; }
+        Result detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated = nullptr) override;
+
+    private:
+        cv::Mat gray_, gradY_, profile_;
+        const double minContrast_ = 4.0; ///< 行平均梯度低于该值视为无液位线
+    };
+} // namespace LevelDetector
+
+#endif
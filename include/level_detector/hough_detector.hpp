@@ -0,0 +1,29 @@
+/**
+ * @file hough_detector.hpp
+ * @note 基于Canny边缘与霍夫直线的液位检测（原有实现，支持窄带跟踪）
+ */
+#ifndef HOUGH_DETECTOR_HPP
+#define HOUGH_DETECTOR_HPP
+
+#include <level_detector/level_detector.hpp>
+
+namespace LevelDetector
+{
+    /**
+     * @brief 霍夫直线液位检测
+     * @note 裁剪区域、缩放与跟踪状态由实例持有，主检测与影子检测可同时使用
+     */
+    class HoughDetector : public Detector
+    {
+    public:
+        const char *name() const override { return "hough"; }
+        Result detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated = nullptr) override;
+        void setTrackingOnly(bool enabled) override;
+        LevelDetectionStats trackingStats() const override;
+
+    private:
+        LevelTracker tracker_;
+    };
+} // namespace LevelDetector
+
+#endif
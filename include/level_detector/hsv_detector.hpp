@@ -0,0 +1,37 @@
+/**
+ * @file hsv_detector.hpp
+ * @note 基于HSV颜色分割的液位检测
+ */
+#ifndef HSV_DETECTOR_HPP
+#define HSV_DETECTOR_HPP
+
+#include <level_detector/level_detector.hpp>
+
+namespace LevelDetector
+{
+    /**
+     * @brief HSV颜色分割液位检测
+     * @note 按颜色范围分割液体，自上而下找到液体占满一行的第一行作为液位线；
+     *       颜色范围与药液和光照有关，需在现场用影子模式验证后再启用
+     */
+    class HsvDetector : public Detector
+    {
+    public:
+        const char *name() const override { return "hsv"; }
+        Result detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated = nullptr) override;
+
+        /**
+         * @brief 设置液体的HSV范围
+         */
+        void setRange(const cv::Scalar &lower, const cv::Scalar &upper);
+
+    private:
+        cv::Mat hsv_, mask_, rowCoverage_;
+        cv::Scalar lower_{0, 40, 30};
+        cv::Scalar upper_{180, 255, 255};
+        const double minRowCoverage_ = 0.5; ///< 行内液体像素占比阈值
+        const int minLiquidRows_ = 3;       ///< 连续满足阈值的行数，抑制噪点
+    };
+} // namespace LevelDetector
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file level_detector.hpp
+ * @note 液位检测策略接口，CameraManager按配置选择具体实现
+ */
+#ifndef LEVEL_DETECTOR_HPP
+#define LEVEL_DETECTOR_HPP
+
+#include <opencv2/opencv.hpp>
+#include "liquid_detector.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LevelDetector
+{
+    /**
+     * @brief 单帧检测结果
+     */
+    struct Result
+    {
+        double percentage = -1.0; ///< 液位线位置占比（0-100，从ROI顶部算起），失败为-1
+        bool skipped = false;     ///< 因负载降级跳过该帧
+    };
+
+    /**
+     * @brief 液位检测策略基类
+     * @note 输出未滤波的液位，滤波由调用方统一完成；同一实例只应由一个线程使用
+     */
+    class Detector
+    {
+    public:
+        virtual ~Detector() = default;
+
+        /**
+         * @brief 策略名称
+         */
+        virtual const char *name() const = 0;
+
+        /**
+         * @brief 检测液位
+         * @param image 输入帧
+         * @param roi 需在CPU上裁剪的区域（相对本帧，旋转后坐标）
+         * @param annotated 非空时输出标注后的ROI图像
+         * @return 检测结果
+         */
+        virtual Result detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated = nullptr) = 0;
+
+        /**
+         * @brief 对同一帧的多个ROI检测，默认逐个调用detect，支持批量推理的策略可覆盖
+         * @param image 输入帧
+         * @param rois ROI列表
+         * @return 与rois一一对应的检测结果
+         */
+        virtual std::vector<Result> detectBatch(const cv::Mat &image, const std::vector<cv::Rect2d> &rois)
+        {
+            std::vector<Result> results;
+            results.reserve(rois.size());
+            for (const auto &roi : rois)
+            {
+                results.push_back(detect(image, roi));
+            }
+            return results;
+        }
+
+        /**
+         * @brief 设置检测分辨率缩放（负载降级）
+         */
+        virtual void setScale(double scale) { scale_ = std::clamp(scale, 0.1, 1.0); }
+
+        /**
+         * @brief 设置仅跟踪模式（负载降级），不支持跟踪的策略忽略
+         */
+        virtual void setTrackingOnly(bool enabled) { (void)enabled; }
+
+        /**
+         * @brief 本实例的液位线跟踪统计，不支持跟踪的策略全为0
+         */
+        virtual LevelDetectionStats trackingStats() const { return LevelDetectionStats(); }
+
+    protected:
+        double scale_ = 1.0;
+    };
+
+    /**
+     * @brief 液位输出滤波：上升时低通，下降时先保持若干帧再低通
+     */
+    class LevelFilter
+    {
+    public:
+        /**
+         * @brief 输入一次原始液位，返回滤波后的液位
+         */
+        double update(double raw);
+
+    private:
+        double last_ = 0.0;
+        double filtered_ = 0.0;
+        int holdCount_ = 0;
+        static constexpr int holdLimit_ = 5; ///< 保持次数限制
+        static constexpr double alpha_ = 0.1; ///< 低通滤波系数
+    };
+
+    /**
+     * @brief 按名称创建检测策略
+     * @param name hough / gradient / hsv / cnn[:模型路径]
+     * @return 检测策略，名称未知或模型加载失败时返回nullptr
+     */
+    std::unique_ptr<Detector> createDetector(const std::string &name);
+} // namespace LevelDetector
+
+#endif
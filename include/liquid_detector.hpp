@@ -1,5 +1,92 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
 
-double detectLiquidLevelPercentage(const cv::Mat& inputImage, double totalVolume = 250.0);
-void setRoiParameters(double startH, double endH, double startW, double endW);
\ No newline at end of file
+/**
+ * @brief 液位检测统计（跟踪与全图扫描）
+ */
+struct LevelDetectionStats
+{
+    uint64_t tracked_frames = 0;      // 由窄带跟踪完成的帧数
+    uint64_t full_scans = 0;          // 全图扫描的帧数
+    uint64_t track_losses = 0;        // 跟丢次数
+    uint64_t skipped_frames = 0;      // 仅跟踪模式下跟丢而跳过的帧数
+    double tracked_ratio = 0.0;       // 跟踪帧占比
+    double tracked_latency_ms = 0.0;  // 跟踪平均耗时
+    double full_scan_latency_ms = 0.0; // 全图扫描平均耗时
+};
+
+class LevelTracker;
+
+/**
+ * @brief 液位检测（多次霍夫检测+分桶+中位平均），按tracker的裁剪区域与跟踪状态检测并更新之
+ * @return 未滤波的液位占比，失败或仅跟踪模式下跳过该帧时返回-1
+ */
+double detectLiquidLevelPercentage(const cv::Mat &inputImage, LevelTracker &tracker, double totalVolume = 250.0,
+                                   cv::Mat *annotatedImage = nullptr);
+
+/**
+ * @brief 霍夫液位检测的裁剪区域、降级参数与液位线跟踪状态
+ * @note 每个检测实例各持有一份，互不干扰；统计可由其他线程读取，其余成员只应由检测线程访问
+ */
+class LevelTracker
+{
+public:
+    /**
+     * @brief 设置裁剪区域（旋转后图像的比例坐标），区域变化时重置跟踪
+     */
+    void setRoi(double startH, double endH, double startW, double endW);
+
+    /**
+     * @brief 启用或关闭窄带跟踪，并重置跟踪
+     */
+    void setTrackingEnabled(bool enabled);
+
+    /**
+     * @brief 设置检测分辨率缩放（负载降级）
+     */
+    void setScale(double scale);
+
+    /**
+     * @brief 设置仅跟踪模式（负载降级）：跟丢时跳过该帧而不做全图扫描
+     */
+    void setTrackingOnly(bool enabled);
+
+    /**
+     * @brief 丢弃上一次的液位线位置，下一帧做全图扫描
+     */
+    void reset();
+
+    /**
+     * @brief 获取本实例的跟踪统计
+     */
+    LevelDetectionStats stats() const;
+
+private:
+    friend double detectLiquidLevelPercentage(const cv::Mat &inputImage, LevelTracker &tracker, double totalVolume,
+                                              cv::Mat *annotatedImage);
+
+    double startHeight_ = 0.1;
+    double endHeight_ = 0.7;
+    double startWidth_ = 0.0;
+    double endWidth_ = 1.0;
+    double scale_ = 1.0;
+    bool trackingEnabled_ = true;
+    bool trackingOnly_ = false;
+    int trackedRow_ = -1;          // 上一次确认的液位线所在行（裁剪图坐标），-1表示未跟踪
+    int trackedCropHeight_ = 0;    // 跟踪时的裁剪图高度，ROI变化后失效
+    int framesSinceFullScan_ = 0;  // 连续跟踪帧数
+    int consecutiveLosses_ = 0;    // 仅跟踪模式下连续跟丢次数
+
+    std::atomic<uint64_t> trackedFrames_{0};
+    std::atomic<uint64_t> fullScans_{0};
+    std::atomic<uint64_t> trackLosses_{0};
+    std::atomic<uint64_t> skippedFrames_{0};
+    std::atomic<int64_t> trackedLatencyNs_{0};
+    std::atomic<int64_t> fullScanLatencyNs_{0};
+};
+
+bool cropLevelRoi(const cv::Mat& inputImage, double startH, double endH, double startW, double endW, double scale,
+                  cv::Mat& croppedImage);
+void setRotateFrame(bool rotate);
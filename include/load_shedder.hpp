@@ -0,0 +1,98 @@
+#ifndef LOAD_SHEDDER_HPP
+#define LOAD_SHEDDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 视觉流水线负载降级控制器
+ * @note 按单帧处理耗时预算逐级降级（降分辨率→仅跟踪→降帧率），
+ *       有余量时逐级恢复。recordFrame只应由检测线程调用，其余接口线程安全
+ */
+class LoadShedder
+{
+public:
+    /**
+     * @brief 降级模式，逐级累加（高一级包含低一级的降级措施）
+     */
+    enum Mode
+    {
+        FULL = 0,           // 全分辨率、全图扫描
+        REDUCED_RESOLUTION, // 降低检测分辨率
+        TRACKING_ONLY,      // 仅窄带跟踪，跟丢时跳过该帧
+        REDUCED_FPS,        // 降低采样帧率
+        MODE_COUNT
+    };
+
+    /**
+     * @brief 构造函数
+     * @param budget 单帧处理耗时预算
+     */
+    explicit LoadShedder(std::chrono::milliseconds budget = std::chrono::milliseconds(50));
+
+    /**
+     * @brief 设置单帧处理耗时预算
+     * @param budget 预算
+     */
+    void setBudget(std::chrono::milliseconds budget);
+
+    /**
+     * @brief 获取单帧处理耗时预算
+     */
+    std::chrono::milliseconds getBudget() const;
+
+    /**
+     * @brief 记录一帧的处理耗时，并按需调整模式
+     * @param cost 处理耗时
+     * @return 模式是否发生变化
+     */
+    bool recordFrame(std::chrono::steady_clock::duration cost);
+
+    /**
+     * @brief 记录因降级被跳过的帧
+     * @param frames 帧数
+     */
+    void recordShed(uint64_t frames = 1);
+
+    /**
+     * @brief 获取当前模式
+     */
+    Mode getMode() const;
+
+    /**
+     * @brief 获取因降级被跳过的帧数
+     */
+    uint64_t getShedFrames() const;
+
+    /**
+     * @brief 恢复全质量模式并清空统计窗口
+     */
+    void reset();
+
+    /**
+     * @brief 模式名称
+     */
+    static const char *modeName(Mode mode);
+
+private:
+    std::atomic<int64_t> budgetNs_;
+    std::atomic<int> mode_{FULL};
+    std::atomic<uint64_t> shedFrames_{0};
+
+    // 以下仅由检测线程访问
+    uint32_t recentOver_ = 0;  // 最近帧是否超预算的位图
+    int underBudget_ = 0;      // 连续有余量的帧数
+    int framesSinceChange_ = 0;
+    int stepUpFrames_;         // 升级所需的连续有余量帧数，频繁反复时加倍
+
+    static constexpr int windowFrames_ = 5;       // 超预算判定窗口
+    static constexpr int stepDownOverFrames_ = 3; // 窗口内超预算帧数达到该值即降级
+    static constexpr int baseStepUpFrames_ = 20;
+    static constexpr int maxStepUpFrames_ = 320;
+    static constexpr double headroom_ = 0.5;      // 耗时低于预算的该比例视为有余量
+
+    void setMode(int mode);
+};
+
+#endif // LOAD_SHEDDER_HPP
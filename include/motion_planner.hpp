@@ -0,0 +1,105 @@
+#ifndef MOTION_PLANNER_HPP
+#define MOTION_PLANNER_HPP
+
+#include <array>
+#include <vector>
+
+/**
+ * @brief 电机运动规划：生成加减速曲线与按步数定义的运动段
+ * @note 曲线形状（梯形或S形）在构造时预计算为归一化位置表，规划时只做查表插值；
+ *       规划结果是一串“速率+持续时间”的点，由MotorDriver在控制线程中按绝对时刻逐点下发。
+ *       速率单位由调用方决定：加减速曲线用RPM，步数运动用步/秒（PWM频率）
+ */
+class MotionPlanner
+{
+public:
+    /**
+     * @brief 加减速曲线类型
+     */
+    enum Profile
+    {
+        TRAPEZOIDAL = 0, // 恒加速度
+        S_CURVE          // 加速度由0线性升降（限制加加速度），峰值为平均值的2倍
+    };
+
+    /**
+     * @brief 规划点：在duration内保持rate
+     */
+    struct Point
+    {
+        double rate;     // 速率
+        double duration; // 持续时间 (s)
+    };
+
+    /**
+     * @brief 规划结果
+     */
+    struct Plan
+    {
+        std::vector<Point> points;
+        double steps = 0.0;    // Σ rate × duration
+        double duration = 0.0; // 总时长 (s)
+
+        /**
+         * @brief 清空，保留容量
+         */
+        void clear();
+    };
+
+    /**
+     * @brief 构造函数
+     * @param tick 规划点的时间间隔 (s)
+     */
+    explicit MotionPlanner(double tick = 0.01);
+
+    /**
+     * @brief 规划从from到to的变速过程
+     * @param from 起始速率
+     * @param to 目标速率
+     * @param accel 最大加速度（速率单位/s）
+     * @param profile 曲线类型
+     * @param plan 输出规划结果，最后一点的速率等于to；from与to相同时为空
+     * @note plan先被清空并复用其容量，预留足够容量时不分配内存
+     */
+    void planRamp(double from, double to, double accel, Profile profile, Plan &plan) const;
+
+    /**
+     * @brief 规划从静止开始、在静止结束、总步数精确为steps的运动段
+     * @param steps 步数（>0）
+     * @param maxRate 匀速段最大步频 (Hz)
+     * @param accel 最大加速度 (Hz/s)
+     * @param profile 曲线类型
+     * @param plan 输出规划结果；每点步频取整（PWM设备只接受整数Hz），由匀速段时长吸收取整误差，
+     *             使Σ rate × duration 等于steps；最后一点步频为0
+     * @note plan先被清空并复用其容量，预留足够容量时不分配内存
+     */
+    void planMove(int steps, double maxRate, double accel, Profile profile, Plan &plan) const;
+
+    /**
+     * @brief 规划点的时间间隔 (s)
+     */
+    double tick() const { return tick_; }
+
+private:
+    static constexpr int tableSize_ = 128;
+
+    /**
+     * @brief 归一化曲线在u∈[0,1]上的位置积分 ∫s(u)du，按表插值
+     */
+    double position(Profile profile, double u) const;
+
+    /**
+     * @brief 给定速度变化量时加速段的时长
+     */
+    static double rampTime(double delta, double accel, Profile profile);
+
+    /**
+     * @brief 生成变速段的规划点（不含结束后的保持点）
+     */
+    void appendRamp(Plan &plan, double from, double to, double accel, Profile profile, bool round) const;
+
+    const double tick_;
+    std::array<std::array<double, tableSize_ + 1>, 2> positionTable_; // [profile][i] = P(i/tableSize_)
+};
+
+#endif // MOTION_PLANNER_HPP
@@ -3,9 +3,19 @@
 
 #include <memory>
 #include <atomic>
-#include <gpiod.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <array>
+#include <functional>
 #include <string>
+#include <vector>
+#include "jitter_histogram.hpp"
+#include "motor_hal/motor_backend.hpp"
+#include "motion_planner.hpp"
 #include "pump_common.hpp"
+#include "step_rate_table.hpp"
 
 /**
  * @brief 合并电机控制和管理的类
@@ -13,7 +23,7 @@
 class MotorDriver {
 public:
     /**
-     * @brief 构造函数
+     * @brief 构造函数，使用libgpiod + pwm_beeper后端
      * @param chipname GPIO芯片名称
      * @param dirPin 方向控制引脚
      * @param microPins 细分控制引脚数组
@@ -21,6 +31,13 @@ public:
      * @param pumpState 泵状态引用
      */
     MotorDriver(const char* chipname, int dirPin, const int microPins[3], const char* motorPwmDevice, PumpState& pumpState);
+
+    /**
+     * @brief 构造函数，使用指定的电机后端
+     * @param backend 电机后端（如仿真后端）
+     * @param pumpState 泵状态引用
+     */
+    MotorDriver(std::shared_ptr<MotorHAL::MotorBackend> backend, PumpState& pumpState);
     
     /**
      * @brief 析构函数
@@ -58,8 +75,11 @@ public:
     int getMicrostep() const;
     
     /**
-     * @brief 设置电机速度
+     * @brief 设置电机速度（立即切换，不经加减速）
      * @param speed 速度(rpm)
+     * @note 控制线程中的变速经过加减速曲线；停止与紧急情况直接调用本方法。
+     *       细分按StepRateTable选择；后端支持非整数频率时直接下发，否则先下发最接近的整数，
+     *       之后由控制线程在相邻两个整数频率间按占空比切换，使平均频率精确
      */
     void setSpeed(double speed);
     
@@ -78,6 +98,7 @@ public:
     void setMotorState(PumpControlState state) {
         // 不能直接访问状态机，仅更新状态
         pumpState_.state.store(state);
+        notify();
     }
     
     /**
@@ -105,24 +126,265 @@ public:
      * @return 是否运行
      */
     bool isControlThreadRunning() const;
+
+    /**
+     * @brief 通知控制线程泵状态或参数已改变，立即处理
+     * @note 修改pumpState.state、pumpParams或参数更新标志后调用；控制线程平时阻塞等待，
+     *       仅在通知或低频的维护超时到来时运行一次
+     */
+    void notify();
+
+    /**
+     * @brief 设置控制线程变速与步数运动使用的加减速曲线
+     * @param profile 曲线类型，默认S形
+     */
+    void setRampProfile(MotionPlanner::Profile profile);
+
+    /**
+     * @brief 控制线程是否正在执行加减速或步数运动
+     */
+    bool isMoving() const;
+
+    /**
+     * @brief 硬件命令统计
+     */
+    struct CommandStats
+    {
+        uint64_t applied = 0;    // 实际下发到硬件的命令数
+        uint64_t suppressed = 0; // 与当前硬件状态相同而被合并的命令数
+        uint64_t syscalls = 0;   // 电机后端写调用次数（GPIO与PWM设备）
+        uint64_t failed = 0;     // 后端写入失败次数（失败的值由控制线程重试）
+    };
+
+    /**
+     * @brief 获取硬件命令统计（方向、细分、频率合计）
+     */
+    CommandStats getCommandStats() const;
+
+    /**
+     * @brief 步数里程计读数
+     */
+    struct Odometer
+    {
+        double revolutions = 0.0; // 净转数，正向为正
+        double volume = 0.0;      // 净输注量 (ml)，未设置流量模型时为0
+    };
+
+    /**
+     * @brief 设置转速→流量模型，用于把里程计转数折算为输注量
+     * @param flowModel 给定转速(rpm)返回流量(ml/h)
+     * @note 在调用线程中按所有可下发的(细分, 频率)预先求出每转输注量，控制线程只查表
+     */
+    void setFlowModel(std::function<double(double)> flowModel);
+
+    /**
+     * @brief 泵数据更新后重新按流量模型建表
+     */
+    void refreshFlowModel();
+
+    /**
+     * @brief 读取里程计，包含当前段截至此刻的部分
+     */
+    Odometer getOdometer() const;
+
+    /**
+     * @brief 里程计清零
+     */
+    void resetOdometer();
+
+    /**
+     * @brief 按当前下发的频率，净输注量达到target还需的时间
+     * @param target 目标输注量 (ml)
+     * @return 秒；已达到时为0，电机停止或未朝target运行时为-1
+     */
+    double timeToVolume(double target) const;
+
+    /**
+     * @brief 设置蠕动泵脉动补偿剖面
+     * @param profile 一转内等角度采样的相对排量（比例任意，首个样本对应转子零位），为空时清除
+     * @note 在调用线程中重采样为每转pulsationSegments_段，每段速率倍数取该段相对排量的倒数，
+     *       并按调和平均归一化，使一转的总时间（即平均转速）不变；控制线程只查表
+     */
+    void setPulsationProfile(const std::vector<double> &profile);
+
+    /**
+     * @brief 启用或关闭脉动补偿
+     * @note 启用且剖面有效时，正向低速运行（每段不短于pulsationMinSegment_）在一转内按剖面调制步频，
+     *       平抑滚轮位置造成的瞬时流量波动；高速或反向时按恒定步频运行
+     */
+    void setPulsationCompensation(bool enabled);
+
+    /**
+     * @brief 设置剖面零位相对电机上电位置的偏移（转）
+     */
+    void setPulsationPhase(double phase);
+
+    /**
+     * @brief 当前是否正在按剖面调制步频
+     */
+    bool isPulsationActive() const;
+
+    /**
+     * @brief 控制线程实时配置
+     */
+    struct RealtimeProfile
+    {
+        bool enabled = false; // 是否启用
+        int priority = 80;    // SCHED_FIFO 优先级 (1-99)
+        int cpu = -1;         // 绑定的CPU核心，-1为不绑定
+    };
+
+    /**
+     * @brief 设置控制线程实时配置，需在startControlThread之前调用
+     * @note 启用后控制线程使用SCHED_FIFO并绑核，锁定进程内存并预先触碰栈；
+     *       循环内不分配内存，日志（含硬件写入失败）写入无锁队列，由flushDeferredLogs在其他线程输出
+     */
+    void setRealtimeProfile(const RealtimeProfile &profile);
+
+    /**
+     * @brief 输出控制线程延后的日志，由非实时线程周期调用
+     */
+    void flushDeferredLogs();
+
+    /**
+     * @brief 控制线程定时统计
+     */
+    struct TimingStats
+    {
+        bool realtime = false;                // 实时配置是否生效
+        JitterHistogram::Snapshot lateness;   // 定时唤醒相对期望时刻的延迟 (µs)
+        JitterHistogram::Snapshot period;     // 规划点实际间隔与计划间隔之差的绝对值 (µs)
+    };
+
+    /**
+     * @brief 获取控制线程定时统计
+     */
+    TimingStats getTimingStats() const;
     
 private:
     std::atomic<bool> control_thread_running_{false};
     std::atomic<double> current_speed_{0.0};
     
-    // GPIO相关变量
-    gpiod_chip* chip_ = nullptr;
-    gpiod_line* dirLine_ = nullptr;
-    gpiod_line* microLines_[3] = {nullptr, nullptr, nullptr};
+    // 电机后端
+    std::shared_ptr<MotorHAL::MotorBackend> backend_;
     int currentDirection_ = 0;
     int currentMicrostep_ = 0;
-    int motor_fd_ = -1;
-    
-    // 电机参数
-    const char* chipname_;
-    int dirPin_;
-    int microPins_[3];
-    const char* motorPwmDevice_;
+
+    // 硬件命令层：缓存已下发的值，只在变化时产生系统调用；-1表示未知（需强制下发）
+    mutable std::mutex hwMutex_;
+    int appliedDirection_ = -1;
+    int appliedMicrostepBits_ = -1;
+    double appliedFrequency_ = -1.0;
+    std::atomic<uint64_t> commandsApplied_{0};
+    std::atomic<uint64_t> commandsSuppressed_{0};
+    std::atomic<uint64_t> syscalls_{0};
+    std::atomic<uint64_t> commandsFailed_{0};
+    // 写入失败待重试的值，-1为无；失败时硬件保持原值，applied*不变
+    bool outputsFailing_ = false;   // 连续失败期间只记录一次日志
+    bool frequencyFailing_ = false;
+    int pendingDirection_ = -1;
+    int pendingMicrostepBits_ = -1;
+    double pendingFrequency_ = -1.0;
+    static constexpr std::chrono::milliseconds writeRetryInterval_{10};
+
+    // 细分档位（StepRateTable下标，-1为停止后未选档）
+    std::atomic<int> rateBand_{-1};
+
+    // 小数频率抖动：在ditherLow_与ditherLow_+1之间切换，一个窗口内高频占ditherFraction_，由hwMutex_保护
+    bool dithering_ = false;
+    double ditherTarget_ = 0.0;  // 目标频率 (Hz)
+    int ditherLow_ = 0;
+    double ditherFraction_ = 0.0;
+    bool ditherHigh_ = false;    // 当前是否处于高频相
+    std::chrono::steady_clock::time_point ditherSwitchAt_;
+    static constexpr std::chrono::milliseconds ditherWindow_{1000};
+
+    // 脉动补偿，由hwMutex_保护
+    static constexpr int pulsationSegments_ = 32;         // 每转分段数
+    static constexpr double pulsationMinSegment_ = 0.02;  // 最短分段时长 (s)，更快时不调制
+    std::array<double, pulsationSegments_> pulsationRate_{}; // 各段速率倍数
+    bool pulsationProfileValid_ = false;
+    bool pulsationEnabled_ = false;
+    double pulsationPhase_ = 0.0;
+    double rotorPosition_ = 0.0;  // 转子位置（转，[0,1)），上电后连续累计，不随里程计清零
+    bool modulating_ = false;
+    double modTarget_ = 0.0;      // 基准频率 (Hz)
+    int modMicrostep_ = 1;
+    int modSegment_ = 0;
+    double modCarry_ = 0.0;       // 频率取整造成的累计时间差 (s)，计入下一段
+    std::chrono::steady_clock::time_point modSwitchAt_;
+
+    // 步数里程计：每次下发频率、方向或细分时结算上一段；段内速率恒定，读数没有轮询误差
+    std::function<double(double)> flowModel_;
+    std::vector<double> mlPerRevTable_;             // [细分编码 × flowTableSize_ + 频率] → 每转输注量 (ml)
+    static constexpr int flowTableSize_ = 512;      // 建表覆盖的频率范围 (Hz)
+    std::chrono::steady_clock::time_point segmentStart_;
+    double segmentRevPerSec_ = 0.0; // 当前段转速 (rev/s)，正向为正
+    double segmentMlPerRev_ = 0.0;  // 当前段每转输注量 (ml)
+    Odometer odometer_;
+    static constexpr double stepsPerRevolution_ = 200.0; // 整步每转（1.8°）
+
+    // 控制线程唤醒：每次通知序号加一，线程比较序号判断是否有未处理的变化
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCond_;
+    uint64_t wakeSeq_ = 0;
+    static constexpr std::chrono::milliseconds housekeepingInterval_{1000}; // 无通知时的维护周期
+
+    // 运动规划
+    MotionPlanner planner_;
+    std::atomic<MotionPlanner::Profile> rampProfile_{MotionPlanner::S_CURVE};
+    std::atomic<bool> moving_{false};
+    MotionPlanner::Plan plan_;                         // 控制线程复用的规划缓冲
+    static constexpr size_t planCapacity_ = 1024;
+    static constexpr double rampAccel_ = 100.0;       // 变速加速度 (RPM/s)
+    static constexpr double moveAccel_ = 165.0;       // 步数运动加速度（整步/s²）
+    static constexpr int retractSteps_ = 32;          // 紧急停止回抽步数（1/4细分下8整步，约等于原5RPM×0.5秒）
+    static constexpr int retractMicrostep_ = 4;       // 回抽细分
+    static constexpr double retractRate_ = 66.0;      // 回抽步频 (Hz)，1/4细分下约5RPM
+
+    // 实时配置与定时统计
+    RealtimeProfile realtimeProfile_;
+    std::atomic<bool> realtimeActive_{false};
+    JitterHistogram latenessHistogram_;
+    JitterHistogram periodHistogram_;
+
+    // 延后日志：多生产者（控制线程与调用setSpeed等的线程）、flushDeferredLogs单消费者的无锁有界队列
+    enum LogEventCode
+    {
+        LOG_DIRECTION_SET,
+        LOG_MICROSTEP_SET,
+        LOG_OUTPUTS_SET,
+        LOG_SPEED_SET,
+        LOG_SPEED_STOPPED,
+        LOG_OUTPUTS_WRITE_FAILED,
+        LOG_OUTPUTS_WRITE_RECOVERED,
+        LOG_FREQUENCY_WRITE_FAILED,
+        LOG_FREQUENCY_WRITE_RECOVERED,
+        LOG_PARAMS_UPDATED,
+        LOG_CALIBRATION_RPM,
+        LOG_RETRACT_START,
+        LOG_RETRACT_ABORTED,
+        LOG_MOTOR_STOPPED,
+        LOG_VTBI_REACHED,
+        LOG_UNKNOWN_STATE
+    };
+    struct LogEvent
+    {
+        LogEventCode code;
+        double a;
+        double b;
+        double c;
+    };
+    struct LogSlot
+    {
+        std::atomic<size_t> sequence; // 等于位置时可写，等于位置+1时可读
+        LogEvent event;
+    };
+    static constexpr size_t logRingSize_ = 64;
+    std::array<LogSlot, logRingSize_> logRing_;
+    std::atomic<size_t> logHead_{0};
+    std::atomic<size_t> logTail_{0};
+    std::atomic<uint64_t> logDropped_{0};
     
     // 泵状态引用
     PumpState& pumpState_;
@@ -133,6 +395,127 @@ private:
      * @param paramsUpdatedFlag 参数更新标志引用
      */
     void controlThread(PumpParams& pumpParams, std::atomic<bool>& paramsUpdatedFlag);
+
+    /**
+     * @brief 细分值转换为3位细分编码
+     * @return 编码，细分值无效时为-1
+     */
+    static int microstepBits(int microstep);
+
+    /**
+     * @brief 同时设置方向与细分
+     * @param direction 方向(0或1)
+     * @param microstep 细分值(1,2,4,8,16,32)
+     */
+    void setOutputs(int direction, int microstep);
+
+    /**
+     * @brief 用一次批量写入下发方向与细分编码，与已下发值相同时不写GPIO
+     * @param direction 方向，-1表示保持
+     * @param bits 细分编码，-1表示保持
+     * @return 是否实际下发
+     */
+    bool applyOutputs(int direction, int bits);
+
+    /**
+     * @brief 下发PWM频率（0为停止），与已下发值相同时不写设备；会结束小数频率抖动与脉动补偿调制
+     * @return 是否实际下发
+     */
+    bool applyFrequency(double frequency);
+
+    /**
+     * @brief 同applyFrequency，但不影响抖动状态，需持有hwMutex_
+     */
+    bool applyFrequencyLocked(double frequency);
+
+    /**
+     * @brief 到达切换时刻时切换抖动相位或脉动补偿分段
+     * @return 下一次切换时刻；未在抖动或调制时为time_point::max()
+     */
+    std::chrono::steady_clock::time_point rateStep(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 从当前转子位置开始按剖面调制，需持有hwMutex_
+     */
+    void startModulation(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 下发当前分段的频率并安排结束时刻，需持有hwMutex_
+     * @param fraction 本段剩余角度占整段的比例
+     */
+    void writeModulationSegment(double fraction);
+
+    /**
+     * @brief 重新下发写入失败的方向/细分与频率
+     * @return 是否仍有未成功下发的值
+     */
+    bool retryFailedWrites();
+
+    /**
+     * @brief 结算当前段到now为止的转数与输注量，需持有hwMutex_
+     */
+    void settleOdometer(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 按已下发的频率、方向和细分开始新的一段，需持有hwMutex_
+     */
+    void startSegment(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 按加减速曲线变速到目标转速，停止（目标为0）时立即停止
+     * @param rpm 目标转速
+     * @param state 发起时的泵状态，状态改变时中止
+     * @return 是否完整执行
+     */
+    bool rampTo(double rpm, PumpControlState state);
+
+    /**
+     * @brief 以固定细分运行精确步数，起止均为静止
+     * @param steps 步数（当前细分下的微步）
+     * @param direction 方向(0或1)
+     * @param microstep 细分值
+     * @param rate 匀速段步频 (Hz)
+     * @param state 发起时的泵状态，状态改变时中止
+     * @return 是否完整执行
+     */
+    bool moveSteps(int steps, int direction, int microstep, double rate, PumpControlState state);
+
+    /**
+     * @brief 按绝对时刻逐点下发规划结果
+     * @param plan 规划结果
+     * @param state 发起时的泵状态，状态改变或线程停止时中止
+     * @param apply 下发一个速率
+     * @return 是否完整执行
+     */
+    bool executePlan(const MotionPlanner::Plan &plan, PumpControlState state,
+                     const std::function<void(double)> &apply);
+
+    /**
+     * @brief 在wakeMutex_上等待至deadline或stop成立；按时到期时记录唤醒延迟
+     * @return stop是否成立
+     */
+    template <typename Stop>
+    bool waitUntil(std::chrono::steady_clock::time_point deadline, Stop stop);
+
+    /**
+     * @brief 在控制线程中应用实时配置
+     */
+    void applyRealtimeProfile();
+
+    /**
+     * @brief 按流量模型重建每转输注量表
+     */
+    void buildFlowTable();
+
+    /**
+     * @brief 记录控制线程事件：实时配置下写入队列，否则直接输出日志
+     */
+    void logEvent(LogEventCode code, double a = 0.0, double b = 0.0, double c = 0.0);
+
+    /**
+     * @brief 输出一条事件日志
+     */
+    static void writeLog(const LogEvent &event);
 };
 
 #endif // MOTOR_DRIVER_HPP
@@ -0,0 +1,60 @@
+/**
+ * @file motor_backend.hpp
+ * @note 步进电机HAL：方向/细分引脚与步进脉冲频率的硬件抽象，MotorDriver只经此接口访问硬件
+ */
+#ifndef MOTOR_BACKEND_HPP
+#define MOTOR_BACKEND_HPP
+
+namespace MotorHAL
+{
+    /**
+     * @brief 电机后端基类
+     * @note 调用方（MotorDriver）负责加锁与合并重复命令，后端每次调用都应实际写入
+     */
+    class MotorBackend
+    {
+    public:
+        bool isOpened = false;
+        int lastError = 0; // 最近一次write*失败的errno；write*不输出日志，由调用方在非实时线程记录
+
+        virtual ~MotorBackend() = default;
+
+        /**
+         * @brief 打开硬件，方向与细分编码初始为0，频率初始为0（停止）
+         * @return 是否成功
+         */
+        virtual bool open() = 0;
+
+        /**
+         * @brief 同时写入方向与细分编码，驱动器不应看到中间组合
+         * @param direction 方向(0或1)
+         * @param microstepBits 3位细分编码(0-5，对应1-32细分)
+         * @return 是否成功
+         */
+        virtual bool writeOutputs(int direction, int microstepBits) = 0;
+
+        /**
+         * @brief 写入步进脉冲频率
+         * @param frequency 频率 (Hz)，0为停止；fractionalFrequency()为false时调用方只传整数
+         * @return 是否成功
+         */
+        virtual bool writeFrequency(double frequency) = 0;
+
+        /**
+         * @brief 是否支持非整数频率
+         */
+        virtual bool fractionalFrequency() const { return false; }
+
+        /**
+         * @brief 关闭硬件
+         */
+        virtual void close() = 0;
+
+        /**
+         * @brief 后端名称，用于日志
+         */
+        virtual const char *name() const = 0;
+    };
+} // namespace MotorHAL
+
+#endif // MOTOR_BACKEND_HPP
@@ -0,0 +1,59 @@
+/**
+ * @file motor_gpiod.hpp
+ * @note libgpiod方向/细分引脚 + pwm_beeper输入设备脉冲的电机后端
+ */
+#ifndef MOTOR_GPIOD_HPP
+#define MOTOR_GPIOD_HPP
+
+#include <motor_hal/motor_backend.hpp>
+#include <gpiod.h>
+
+namespace MotorHAL
+{
+    /**
+     * @brief libgpiod + pwm_beeper 电机后端
+     */
+    class MotorBackend_Gpiod : public MotorBackend
+    {
+    protected:
+        const char *chipname_;
+        int dirPin_;
+        int microPins_[3];
+        const char *pwmDevice_;
+
+        gpiod_chip *chip_ = nullptr;
+        gpiod_line *dirLine_ = nullptr;
+        gpiod_line *microLines_[3] = {nullptr, nullptr, nullptr};
+        gpiod_line_bulk outputLines_; // 方向与3个细分引脚，批量请求与写入
+        int pwm_fd_ = -1;
+
+    public:
+        /**
+         * @param chipname GPIO芯片名称
+         * @param dirPin 方向控制引脚
+         * @param microPins 细分控制引脚数组
+         * @param pwmDevice PWM（pwm_beeper）输入设备路径
+         */
+        MotorBackend_Gpiod(const char *chipname, int dirPin, const int microPins[3], const char *pwmDevice);
+        ~MotorBackend_Gpiod();
+
+        bool open() override;
+        bool writeOutputs(int direction, int microstepBits) override;
+        bool writeFrequency(double frequency) override;
+        void close() override;
+        const char *name() const override { return "gpiod"; }
+
+    protected:
+        /**
+         * @brief 打开步进脉冲发生器（pwm_beeper设备），派生类可替换
+         */
+        virtual bool openPulse();
+
+        /**
+         * @brief 关闭步进脉冲发生器
+         */
+        virtual void closePulse();
+    };
+} // namespace MotorHAL
+
+#endif // MOTOR_GPIOD_HPP
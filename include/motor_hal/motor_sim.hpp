@@ -0,0 +1,137 @@
+/**
+ * @file motor_sim.hpp
+ * @note 仿真电机后端：按频率积分步数，可选地在定长环形缓冲中记录最近的命令，可注入写入失败与写入延迟，
+ *       用于在非目标硬件上运行控制线程、运动规划与剂量逻辑
+ */
+#ifndef MOTOR_SIM_HPP
+#define MOTOR_SIM_HPP
+
+#include <motor_hal/motor_backend.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace MotorHAL
+{
+    /**
+     * @brief 仿真电机后端
+     */
+    class MotorBackend_Sim : public MotorBackend
+    {
+    public:
+        /**
+         * @brief 一条已记录的命令
+         */
+        struct Command
+        {
+            enum Type
+            {
+                OUTPUTS = 0, // 方向与细分
+                FREQUENCY    // 脉冲频率
+            };
+            Type type;
+            std::chrono::steady_clock::time_point time; // 写入生效时刻（含注入延迟）
+            int direction;                              // OUTPUTS: 方向
+            int microstepBits;                          // OUTPUTS: 细分编码
+            double frequency;                           // FREQUENCY: 频率 (Hz)
+            bool failed;                                // 是否被注入为失败（失败的命令不改变仿真状态）
+        };
+
+        /**
+         * @brief 故障注入配置
+         */
+        struct Faults
+        {
+            double failProbability = 0.0;                // 每次写入失败的概率
+            uint64_t failEvery = 0;                      // 每N次写入失败一次，0为不启用
+            std::chrono::microseconds writeDelay{0};     // 每次写入前的延迟
+            std::chrono::microseconds writeJitter{0};    // 在writeDelay基础上附加的均匀随机延迟上限
+        };
+
+        /**
+         * @param seed 故障注入随机种子
+         * @param fractional 是否模拟支持非整数频率的脉冲发生器（如sysfs PWM）
+         * @param commandCapacity 保留的最近命令条数，0为不记录；缓冲在构造时一次性分配，写入时不再分配内存
+         */
+        explicit MotorBackend_Sim(unsigned seed = 1, bool fractional = false, size_t commandCapacity = 0);
+
+        bool open() override;
+        bool writeOutputs(int direction, int microstepBits) override;
+        bool writeFrequency(double frequency) override;
+        bool fractionalFrequency() const override { return fractional_; }
+        void close() override;
+        const char *name() const override { return "sim"; }
+
+        /**
+         * @brief 设置故障注入
+         */
+        void setFaults(const Faults &faults);
+
+        /**
+         * @brief 获取已记录命令的副本，按时间先后排列；缓冲满后只保留最近commandCapacity条
+         */
+        std::vector<Command> getCommands() const;
+
+        /**
+         * @brief 因缓冲已满被覆盖的命令条数
+         */
+        uint64_t getDroppedCommands() const;
+
+        /**
+         * @brief 清空命令记录，不影响步数累计
+         */
+        void clearCommands();
+
+        /**
+         * @brief 截至此刻的净步数（整步），正向为正
+         */
+        double getFullSteps() const;
+
+        /**
+         * @brief 截至此刻的净转数，正向为正
+         */
+        double getRevolutions() const;
+
+        /**
+         * @brief 步数累计清零
+         */
+        void resetSteps();
+
+    private:
+        static constexpr double stepsPerRevolution_ = 200.0; // 整步每转（1.8°）
+
+        const bool fractional_;
+        mutable std::mutex mutex_;
+        std::vector<Command> commands_; // 环形缓冲，容量固定
+        uint64_t commandCount_ = 0;     // 累计记录条数，下一条写入commands_[commandCount_ % 容量]
+        Faults faults_;
+        std::mt19937 rng_;
+        uint64_t writes_ = 0;
+
+        // 当前仿真状态与步数累计
+        int direction_ = 0;
+        int microstepBits_ = 0;
+        double frequency_ = 0.0;
+        std::chrono::steady_clock::time_point segmentStart_;
+        double fullSteps_ = 0.0;
+
+        /**
+         * @brief 执行注入延迟并判定本次写入是否失败，返回时已持有锁
+         */
+        bool injectFault(std::unique_lock<std::mutex> &lock);
+
+        /**
+         * @brief 记录一条命令，需持有mutex_
+         */
+        void record(const Command &command);
+
+        /**
+         * @brief 当前段截至now的整步数，需持有mutex_
+         */
+        double segmentSteps(std::chrono::steady_clock::time_point now) const;
+    };
+} // namespace MotorHAL
+
+#endif // MOTOR_SIM_HPP
@@ -0,0 +1,72 @@
+/**
+ * @file motor_sysfs_pwm.hpp
+ * @note 方向/细分引脚沿用libgpiod，步进脉冲由内核PWM类（/sys/class/pwm）产生的电机后端
+ */
+#ifndef MOTOR_SYSFS_PWM_HPP
+#define MOTOR_SYSFS_PWM_HPP
+
+#include <motor_hal/motor_gpiod.hpp>
+#include <string>
+
+namespace MotorHAL
+{
+    /**
+     * @brief libgpiod + sysfs PWM 电机后端
+     * @note 周期与占空比以纳秒写入，频率不限于整数Hz。变频时按新旧周期大小决定先写周期还是先写占空比，
+     *       任一时刻占空比都不超过周期（内核会拒绝反之的写入）；两次写入之间每个周期仍只有一个脉冲，不丢步也不多步。
+     *       芯片路径可配置，可在伪造的sysfs目录树上测试
+     */
+    class MotorBackend_SysfsPwm : public MotorBackend_Gpiod
+    {
+    private:
+        std::string chipPath_;    // 如 /sys/class/pwm/pwmchip0
+        int channel_;
+        std::string channelPath_; // chipPath_/pwmN
+        bool exported_ = false;   // 是否由本后端导出（关闭时取消导出）
+        static constexpr long long initialPeriodNs_ = 1000000; // 新导出通道周期为0时先写入的周期（1 ms）
+
+        int periodFd_ = -1;
+        int dutyFd_ = -1;
+        int enableFd_ = -1;
+        long long periodNs_ = 0;  // 已写入的周期，0为未写入
+        bool enabled_ = false;
+
+    public:
+        /**
+         * @param chipname GPIO芯片名称
+         * @param dirPin 方向控制引脚
+         * @param microPins 细分控制引脚数组
+         * @param pwmChip PWM芯片目录，如 /sys/class/pwm/pwmchip0
+         * @param channel PWM通道号
+         */
+        MotorBackend_SysfsPwm(const char *chipname, int dirPin, const int microPins[3],
+                              const std::string &pwmChip, int channel);
+        ~MotorBackend_SysfsPwm();
+
+        bool writeFrequency(double frequency) override;
+        bool fractionalFrequency() const override { return true; }
+        const char *name() const override { return "sysfs-pwm"; }
+
+    protected:
+        bool openPulse() override;
+        void closePulse() override;
+
+    private:
+        /**
+         * @brief 向sysfs属性写入一个整数
+         */
+        static bool writeValue(int fd, long long value);
+
+        /**
+         * @brief 向sysfs属性文件写入一个整数（只写一次的属性，如export）
+         */
+        static bool writeFile(const std::string &path, long long value);
+
+        /**
+         * @brief 从sysfs属性文件读取一个整数
+         */
+        static bool readFile(const std::string &path, long long &value);
+    };
+} // namespace MotorHAL
+
+#endif // MOTOR_SYSFS_PWM_HPP
@@ -62,11 +62,12 @@ public:
     /**
      * @brief 设置泵数据库
      * @param pumpDatabase 泵数据库指针
-     * @param pumpName 泵名称
+     * @param pumpName 泵名称，在此解析为句柄，之后不再按名称查找
      */
     void setPumpDatabase(PumpDatabase* pumpDatabase, const std::string& pumpName) {
         pumpDatabase_ = pumpDatabase;
         pumpName_ = pumpName;
+        pump_ = pumpDatabase ? pumpDatabase->getHandle(pumpName) : nullptr;
     }
     
 private:
@@ -83,6 +84,7 @@ private:
     // 泵数据库
     PumpDatabase* pumpDatabase_ = nullptr;
     std::string pumpName_;
+    const PumpHandle* pump_ = nullptr;
     
     // 线程运行标志
     std::atomic<bool> thread_running_{false};
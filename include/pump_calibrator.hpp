@@ -0,0 +1,156 @@
+#ifndef PUMP_CALIBRATOR_HPP
+#define PUMP_CALIBRATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "pump_common.hpp"
+#include "pump_database.hpp"
+#include "regression_sums.hpp"
+
+class InfusionStateMachine;
+class MotorDriver;
+
+/**
+ * @brief 泵现场自动标定：按转速序列逐级运行电机，由液位变化测量实际流量
+ * @note 在独立线程中运行，期间泵处于CALIBRATING状态；每级用液位-时间回归求出流量，
+ *       实测精度达到要求或超过单级时长上限后进入下一级。结束后替换泵数据库中的
+ *       rpm_flow_points 并保存，拟合由PumpDatabase完成
+ */
+class PumpCalibrator
+{
+public:
+    /**
+     * @brief 药瓶容量曲线：剩余液位(%) → 剩余容量(ml)，分段线性插值
+     */
+    struct BottleProfile
+    {
+        std::vector<std::pair<double, double>> points; // 按液位升序
+
+        /**
+         * @brief 线性药瓶（容量与液位成正比）
+         * @param volume 满瓶容量 (ml)
+         */
+        static BottleProfile linear(double volume);
+
+        /**
+         * @brief 由液位计算剩余容量
+         */
+        double volumeAt(double level) const;
+    };
+
+    /**
+     * @brief 单级测量结果
+     */
+    struct Step
+    {
+        double rpm = 0.0;
+        double flow_rate = 0.0;   // 实测流量 (ml/h)
+        double flow_stderr = 0.0; // 实测流量标准误差 (ml/h)
+        double duration = 0.0;    // 测量时长 (s)
+        int samples = 0;
+        bool valid = false;
+    };
+
+    /**
+     * @brief 标定进度
+     */
+    struct Status
+    {
+        std::string phase = "idle"; // idle, running, done, failed, cancelled
+        std::string message;
+        int current_step = 0;
+        int total_steps = 0;
+        std::vector<Step> steps;
+        double fit_rms_error = 0.0; // 拟合曲线相对实测点的均方根相对误差
+    };
+
+    /**
+     * @brief 构造函数
+     * @param stateMachine 状态机
+     * @param motorDriver 电机驱动（改变转速后通知控制线程）
+     * @param pumpParams 泵参数
+     * @param paramsUpdatedFlag 参数更新标志
+     * @param pumpDatabase 泵数据库
+     * @param pumpName 泵名称
+     */
+    PumpCalibrator(InfusionStateMachine &stateMachine, MotorDriver &motorDriver, PumpParams &pumpParams,
+                   std::atomic<bool> &paramsUpdatedFlag, PumpDatabase &pumpDatabase,
+                   const std::string &pumpName);
+
+    /**
+     * @brief 析构函数，取消并等待标定线程
+     */
+    ~PumpCalibrator();
+
+    /**
+     * @brief 开始标定，泵需处于IDLE状态
+     * @param rpms 转速序列
+     * @param profile 药瓶容量曲线，为空时按泵参数中的药瓶容量取线性药瓶
+     * @param maxStep 单级最长时长
+     * @return 是否成功开始
+     */
+    bool start(const std::vector<double> &rpms, const BottleProfile &profile,
+               std::chrono::seconds maxStep = std::chrono::seconds(600));
+
+    /**
+     * @brief 取消标定，已测得的点不保存
+     */
+    void cancel();
+
+    /**
+     * @brief 添加液位样本，由相机检测线程调用
+     * @param level 剩余液位 (0-100%)
+     * @param time 采样时间
+     */
+    void addLevelSample(double level, std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief 获取标定进度
+     */
+    Status getStatus() const;
+
+    /**
+     * @brief 是否正在标定
+     */
+    bool isRunning() const { return running_.load(); }
+
+private:
+    void run(std::vector<double> rpms, std::chrono::seconds maxStep);
+    bool measureStep(double rpm, std::chrono::seconds maxStep, Step &step);
+    bool savePoints(const std::vector<Step> &steps);
+    void finish(const std::string &phase, const std::string &message);
+
+    InfusionStateMachine &stateMachine_;
+    MotorDriver &motorDriver_;
+    PumpParams &pumpParams_;
+    std::atomic<bool> &paramsUpdatedFlag_;
+    PumpDatabase &pumpDatabase_;
+    std::string pumpName_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancel_{false};
+
+    mutable std::mutex mutex_;
+    Status status_;
+    BottleProfile profile_;
+
+    // 当前级的回归累加量（相对本级起点的时间）
+    bool collecting_ = false;
+    std::chrono::steady_clock::time_point stepStart_;
+    double lastLevel_ = 100.0;
+    RegressionSums sums_;
+
+    static constexpr double settleSeconds_ = 5.0;   // 改变转速后丢弃的时长 (s)
+    static constexpr double minStepSeconds_ = 30.0; // 单级最短测量时长 (s)
+    static constexpr double targetRelError_ = 0.02; // 实测流量相对标准误差目标
+    static constexpr double minLevel_ = 10.0;       // 液位低于该值时停止标定 (%)
+    static constexpr int minPoints_ = 3;            // 保存所需的最少有效点数
+};
+
+#endif // PUMP_CALIBRATOR_HPP
@@ -14,6 +14,7 @@ enum PumpControlState
     PAUSED,         // 暂停状态
     EMERGENCY_STOP, // 紧急停止状态
     ERROR,          // 错误状态
+    CALIBRATING,    // 现场标定状态
 };
 
 struct PumpState
@@ -24,6 +25,14 @@ struct PumpState
     std::atomic<bool> direction{false};
     std::atomic<double> infusion_progress{0.0};
     std::atomic<int> remaining_time{0};
+    std::atomic<int> remaining_time_low{0};     // 剩余时间置信区间下限（秒）
+    std::atomic<int> remaining_time_high{0};    // 剩余时间置信区间上限（秒）
+    std::atomic<bool> dry_early_warning{false}; // 药液将早于计划排空
+    std::atomic<double> measured_flow_rate{0.0};  // 液位下降折算的实测流量（ml/h）
+    std::atomic<int> flow_alarm{0};               // 流量监测报警（FlowMonitor::Alarm）
+    std::atomic<double> flow_trim{0.0};           // 流量闭环的转速修正系数，0为开环
+    std::atomic<double> delivered_volume{0.0};    // 步数里程计折算的已输注量（ml）
+    std::atomic<bool> vtbi_reached{false};        // 已达到待输注量，电机已停止
     std::atomic<PumpControlState> state{IDLE};
 };
 
@@ -32,6 +41,8 @@ struct PumpParams
     std::atomic<double> target_flow_rate{0.0};
     std::atomic<double> target_rpm{0.0};
     std::atomic<bool> direction{false};
+    std::atomic<double> bottle_volume{100.0}; // 药瓶容量（ml）
+    std::atomic<double> vtbi{0.0};            // 待输注量（ml），达到后停止输液；0为不限
 };
 
 #endif // PUMP_COMMON_HPP
\ No newline at end of file
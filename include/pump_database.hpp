@@ -3,6 +3,10 @@
 
 #include <string>
 #include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <functional>
 #include <nlohmann/json.hpp>
 #include <gsl/gsl_multifit.h> // 需要GSL库支持
@@ -22,12 +26,69 @@ struct FlowRPMPoint
     FlowRPMPoint() : rpm(0.0), flow_rate(0.0) {}
 };
 
+/**
+ * @brief 缓存的转速-流量模型
+ * @note 由PumpDatabase在加载、添加、更新或校准泵数据时拟合一次；求值只用系数和预计算表，不分配内存、不抛异常
+ */
+struct FlowModel
+{
+    /**
+     * @brief 模型类型
+     */
+    enum Type
+    {
+        POLYNOMIAL = 0, // 二次多项式求流量，一次拟合反算转速（两个方向互不一致）
+        PCHIP           // 单调分段三次Hermite插值，反算查表后做一步牛顿修正；两个方向单调，往返误差在1e-6量级以内
+    };
+
+    static constexpr int inverseTableSize = 512; // PCHIP反查表点数
+
+    bool valid = false;               // 有可用数据
+    Type type = POLYNOMIAL;           // 实际使用的模型，PCHIP节点不足时退回POLYNOMIAL
+
+    // POLYNOMIAL
+    double flow[3] = {0.0, 0.0, 0.0}; // 流量 = flow[0] + flow[1]·rpm + flow[2]·rpm²
+    bool rpmLinear = false;           // 反算用一次拟合的闭式解；为false时在原始点间线性插值
+    double rpm[2] = {0.0, 0.0};       // 一次拟合：流量 = rpm[0] + rpm[1]·rpm
+
+    // PCHIP：节点按转速升序，流量单调不减；节点范围外按端区间割线线性外推
+    std::vector<double> knotRpm;
+    std::vector<double> knotFlow;
+    std::vector<double> knotSlope;     // 各节点导数 d流量/d转速
+    std::vector<double> inverseRpm;    // 反查表：第i项为流量 inverseFlow0 + inverseSpan·(i/(N-1))² 对应的转速
+    double inverseFlow0 = 0.0;
+    double inverseSpan = 0.0;          // 反查表覆盖的流量范围，按平方间距使低流量端更密
+};
+
 struct PumpData
 {
     std::string pump_name;
     double target_flow_rate_offset = 0.0;          // 目标流量偏移量
     std::vector<FlowRPMPoint> rpm_flow_points;     // 转速-流量原始数据
     std::vector<FlowRPMPoint> rpm_flow_calibrated; // 校准后的转速-流量数据
+    std::vector<double> pulsation_profile;          // 一转内等角度采样的相对排量，用于脉动补偿；空表示未标定
+    FlowModel::Type flow_model_type = FlowModel::POLYNOMIAL; // 流量模型类型，JSON中为"flow_model"
+    FlowModel flow_model;                           // 拟合缓存，由PumpDatabase维护，不写入文件
+};
+
+// 泵数据快照：发布后不再修改，持有者可在任意线程无锁读取
+using PumpSnapshot = std::shared_ptr<const PumpData>;
+
+/**
+ * @brief 泵句柄，指向数据库中某台泵的固定位置
+ * @note 更新泵数据时数据库先构建完整的新快照（含拟合好的流量模型），再原子替换句柄中的快照，
+ *       已发布的快照不会被修改；读者每次计算前load()一次，整个计算都在同一份快照上完成
+ */
+class PumpHandle
+{
+public:
+    PumpSnapshot load() const { return std::atomic_load(&data_); }
+
+private:
+    friend class PumpDatabase;
+    void store(PumpSnapshot data) { std::atomic_store(&data_, std::move(data)); }
+
+    PumpSnapshot data_;
 };
 
 class PumpDatabase
@@ -39,13 +100,20 @@ public:
 
     // 文件操作
     void loadFromFile(const std::string &file_name);
-    void saveToFile();
-    void saveToFile(const std::string &file_name);
+    // 保存失败时恢复原文件并返回false
+    bool saveToFile();
+    bool saveToFile(const std::string &file_name);
 
     // 核心计算
     double calculateFlowRate(const std::string &pump_name, double rpm);
     double calculateRPM(const std::string &pump_name, double flow_rate);
 
+    // 按快照或句柄计算，省去按名称查找
+    static double calculateFlowRate(const PumpData &pump, double rpm);
+    static double calculateRPM(const PumpData &pump, double flow_rate);
+    static double calculateFlowRate(const PumpHandle &pump, double rpm);
+    static double calculateRPM(const PumpHandle &pump, double flow_rate);
+
     // 校准功能
     void calibrateFlowRate(const std::string &pump_name,
                            const std::vector<FlowRPMPoint> &calibration_data,
@@ -58,23 +126,34 @@ public:
     bool empty();
 
     // 获取数据
-    const PumpData *getPump(const std::string &pump_name);
-    const std::vector<PumpData> *getPumps();
+    // 返回当前快照，之后的更新不影响已取得的快照；修改后需通过updatePump提交，不可修改pump_name
+    PumpSnapshot getPump(const std::string &pump_name);
+    std::vector<PumpSnapshot> getPumps();
 
-    PumpData *findPump(const std::string &pump_name);
+    // 返回可长期保存的句柄，该泵被删除或重新加载文件前一直有效；通过句柄读取无需加锁，可看到之后的更新
+    const PumpHandle *getHandle(const std::string &pump_name);
 
 private:
-    // 私有辅助函数
+    // 私有辅助函数，需持有mutex_
+    PumpHandle *findPump(const std::string &pump_name);
     void loadFromJson(const json &j);
     void saveToJson(json &j) const;
 
-    static void polyfit(const std::vector<FlowRPMPoint> &points,
+    static bool polyfit(const std::vector<FlowRPMPoint> &points,
                         int degree,
                         std::vector<double> &coefficients,
                         double &chisq);
 
-    std::vector<PumpData> pumps_;
+    // 按rpm_flow_points拟合流量模型；在局部对象中完整构建后返回，由调用方一次性赋给flow_model
+    static FlowModel fitModel(const PumpData &pd);
+
+    // 拟合单调PCHIP曲线并生成反查表，成功时才写入model；有效节点不足时返回false
+    static bool fitPchip(const std::vector<FlowRPMPoint> &points, FlowModel &model);
+
+    std::mutex mutex_;                                                       // 串行各成员函数；句柄与快照的读取不经过此锁
+    std::list<PumpHandle> pumps_;                                            // 泵句柄，元素地址稳定
+    std::unordered_map<std::string, std::list<PumpHandle>::iterator> index_; // 名称索引，与pumps_同步
     std::string file_name_;
 };
 
-#endif // PUMP_DATABASE_HPP
\ No newline at end of file
+#endif // PUMP_DATABASE_HPP
@@ -0,0 +1,98 @@
+#ifndef REGRESSION_SUMS_HPP
+#define REGRESSION_SUMS_HPP
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief 直线回归 y = a + b·t 的累加量，样本可增删，也可整体按指数遗忘衰减
+ * @note 流量监测、剩余时间估计与现场标定共用；t取相对某原点的秒数，
+ *       原点应靠近样本，以减少平方项的精度损失
+ */
+struct RegressionSums
+{
+    // Σw, Σw², Σwt, Σwy, Σwt², Σwty, Σwy²
+    double w = 0.0, w2 = 0.0, st = 0.0, sy = 0.0, stt = 0.0, sty = 0.0, syy = 0.0;
+
+    /**
+     * @brief 回归结果，二阶量均已在加权均值处中心化
+     */
+    struct Fit
+    {
+        bool valid = false;  // sxx>0，斜率有定义
+        double meanT = 0.0;
+        double meanY = 0.0;
+        double sxx = 0.0;
+        double sxy = 0.0;
+        double slope = 0.0;
+        double sigma2 = 0.0; // 残差方差
+    };
+
+    void add(double t, double y)
+    {
+        w += 1.0;
+        w2 += 1.0;
+        st += t;
+        sy += y;
+        stt += t * t;
+        sty += t * y;
+        syy += y * y;
+    }
+
+    // 仅用于未衰减的累加量（滑动窗口移出最旧样本）
+    void remove(double t, double y)
+    {
+        w -= 1.0;
+        w2 -= 1.0;
+        st -= t;
+        sy -= y;
+        stt -= t * t;
+        sty -= t * y;
+        syy -= y * y;
+    }
+
+    // 已有样本权重整体乘以factor
+    void decay(double factor)
+    {
+        w *= factor;
+        w2 *= factor * factor;
+        st *= factor;
+        sy *= factor;
+        stt *= factor;
+        sty *= factor;
+        syy *= factor;
+    }
+
+    void clear()
+    {
+        *this = RegressionSums();
+    }
+
+    // 有效样本数 (Σw)²/Σw²，等权时即样本数
+    double effectiveCount() const
+    {
+        return w2 > 0 ? w * w / w2 : 0.0;
+    }
+
+    Fit fit() const
+    {
+        Fit result;
+        if (w <= 0)
+            return result;
+        result.meanT = st / w;
+        result.meanY = sy / w;
+        result.sxx = stt - w * result.meanT * result.meanT;
+        result.sxy = sty - w * result.meanT * result.meanY;
+        if (result.sxx <= 0)
+            return result;
+
+        double syyc = syy - w * result.meanY * result.meanY;
+        double nEff = effectiveCount();
+        result.slope = result.sxy / result.sxx;
+        result.sigma2 = nEff > 2 ? std::max(syyc - result.slope * result.sxy, 0.0) / w * nEff / (nEff - 2) : 0.0;
+        result.valid = true;
+        return result;
+    }
+};
+
+#endif // REGRESSION_SUMS_HPP
@@ -0,0 +1,71 @@
+#ifndef REMAINING_TIME_ESTIMATOR_HPP
+#define REMAINING_TIME_ESTIMATOR_HPP
+
+#include <chrono>
+#include <mutex>
+#include "regression_sums.hpp"
+
+/**
+ * @brief 基于液位-时间在线回归的剩余时间估计
+ * @note 维护指数遗忘加权的线性回归累加量，每个样本O(1)更新；
+ *       由液位下降斜率外推排空时间，并用参数协方差给出置信区间
+ */
+class RemainingTimeEstimator
+{
+public:
+    /**
+     * @brief 估计结果
+     */
+    struct Estimate
+    {
+        bool valid = false;          // 样本足够且液位在下降
+        double level = 0.0;          // 回归得到的当前剩余液位 (%)
+        double slope = 0.0;          // 液位变化速率 (%/s)，下降为负
+        double remaining = 0.0;      // 预计剩余时间 (s)
+        double remaining_low = 0.0;  // 置信区间下限 (s)
+        double remaining_high = 0.0; // 置信区间上限 (s)
+        int samples = 0;             // 参与回归的样本数
+    };
+
+    /**
+     * @brief 构造函数
+     * @param window 遗忘时间常数，越早的样本权重按 exp(-Δt/window) 衰减
+     */
+    explicit RemainingTimeEstimator(std::chrono::seconds window = std::chrono::seconds(600));
+
+    /**
+     * @brief 添加液位样本
+     * @param level 剩余液位 (0-100%)
+     * @param time 采样时间
+     */
+    void addSample(double level, std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief 获取当前估计
+     * @param now 当前时间
+     * @return 估计结果
+     */
+    Estimate estimate(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 清空样本（更换药瓶或停止输液时）
+     */
+    void reset();
+
+private:
+    mutable std::mutex mutex_;
+    const double tau_;            // 遗忘时间常数 (s)
+    bool hasOrigin_ = false;
+    std::chrono::steady_clock::time_point origin_;
+    double lastT_ = 0.0;          // 最近样本时间（相对origin_，s）
+    int count_ = 0;
+
+    // 液位-时间的指数遗忘加权回归累加量
+    RegressionSums sums_;
+
+    static constexpr int minSamples_ = 10;
+    static constexpr double minSpan_ = 60.0;   // 样本跨度至少60秒才给出估计
+    static constexpr double z_ = 1.96;         // 95%置信区间
+};
+
+#endif // REMAINING_TIME_ESTIMATOR_HPP
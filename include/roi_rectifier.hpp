@@ -0,0 +1,82 @@
+#ifndef ROI_RECTIFIER_HPP
+#define ROI_RECTIFIER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 瓶体ROI矫正：镜头畸变校正与透视校正合并为一张重映射表
+ * @note 映射表只覆盖ROI输出像素，每帧只做一次cv::remap（每像素一次查表），
+ *       ROI、帧视场或帧尺寸变化时才重建。裁剪、缩放和CPU旋转也并入同一张表
+ */
+class RoiRectifier
+{
+public:
+    /**
+     * @brief 加载相机安装标定文件（cv::FileStorage格式）
+     * @param path 文件路径，包含 camera_matrix、distortion_coefficients、image_width、image_height，
+     *             可选 plane_homography（将去畸变后的正立全视场像素映射到瓶体正视平面）
+     * @return 是否加载成功
+     */
+    bool loadCalibration(const std::string &path);
+
+    /**
+     * @brief 是否已加载镜头标定
+     */
+    bool hasCalibration() const { return calibrated_; }
+
+    /**
+     * @brief 设置瓶体ROI
+     * @param roi ROI（正立全视场归一化坐标，畸变图像上的矩形）
+     */
+    void setRoi(const cv::Rect2d &roi);
+
+    /**
+     * @brief 对一帧做ROI矫正
+     * @param frame 输入帧
+     * @param frameView 该帧对应的全视场区域（ISP裁剪，正立归一化坐标）
+     * @param rotated 帧是否倒置（ISP未旋转）
+     * @param output 输出正立、去畸变、正视的ROI图像
+     * @return 是否成功
+     */
+    bool rectify(const cv::Mat &frame, const cv::Rect2d &frameView, bool rotated, cv::Mat &output);
+
+    /**
+     * @brief 映射表重建次数
+     */
+    uint64_t rebuildCount() const { return rebuilds_.load(); }
+
+private:
+    // 镜头标定
+    bool calibrated_ = false;
+    cv::Mat cameraMatrix_;
+    cv::Mat distCoeffs_;
+    cv::Mat planeHomography_;
+    cv::Size calibSize_{640, 480};
+
+    // 当前映射表对应的参数
+    cv::Rect2d roi_{0, 0, 1, 1};
+    bool roiChanged_ = true;
+    cv::Size frameSize_;
+    cv::Rect2d frameView_;
+    bool rotated_ = false;
+
+    // 定点格式映射表（cv::convertMaps生成），remap速度最快
+    cv::Mat map1_;
+    cv::Mat map2_;
+    std::atomic<uint64_t> rebuilds_{0};
+
+    /**
+     * @brief 重建映射表
+     */
+    bool rebuildMaps(const cv::Size &frameSize, const cv::Rect2d &frameView, bool rotated);
+
+    /**
+     * @brief 对去畸变像素坐标施加镜头畸变，得到原始图像中的像素坐标
+     */
+    cv::Point2d distort(const cv::Point2d &point) const;
+};
+
+#endif // ROI_RECTIFIER_HPP
@@ -8,6 +8,9 @@
 #include <nlohmann/json.hpp>
 #include "infusion_state_machine.hpp"
 
+class CameraManager;
+class PumpCalibrator;
+
 using json = nlohmann::json;
 using RpcFunction = std::function<std::string(const json&)>;
 
@@ -26,5 +29,7 @@ std::string dispatch_rpc(const std::string& request_json);
 extern MotorDriver *g_motorDriver;
 extern PumpParams g_pumpParams;
 extern InfusionStateMachine *g_stateMachine;
+extern CameraManager *g_cameraManager;
+extern PumpCalibrator *g_pumpCalibrator;
 
 #endif // RPC_HPP
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef STEP_RATE_TABLE_HPP
+#define STEP_RATE_TABLE_HPP
+
+#include <array>
+
+/**
+ * @brief 转速→(细分, 步进脉冲频率) 映射表
+ * @note 沿用原有规则：选择满足 频率×细分 < 500 的最细细分，即细分m可用的最高转速为 150/m² RPM；
+ *       表在编译期生成。降速切换到更细细分时要求转速低于该档上限的(1-hysteresis)，
+ *       避免转速在档位边界附近波动时细分来回切换
+ */
+class StepRateTable
+{
+public:
+    /**
+     * @brief 一个细分档位
+     */
+    struct Band
+    {
+        int microstep;   // 细分值
+        double maxRpm;   // 本档可用的最高转速（不含）
+        double hzPerRpm; // 每RPM对应的脉冲频率 (Hz)
+    };
+
+    static constexpr int bandCount = 6;
+    static constexpr double stepsPerRevolution = 200.0; // 整步每转（1.8°）
+    static constexpr double maxFrequencyProduct = 500.0; // 频率×细分上限
+    static constexpr double hysteresis = 0.05;           // 降档（换更细细分）回差
+
+    /**
+     * @brief 档位表，下标0为最细细分
+     */
+    static constexpr std::array<Band, bandCount> bands = []
+    {
+        std::array<Band, bandCount> table{};
+        constexpr int microsteps[bandCount] = {32, 16, 8, 4, 2, 1};
+        for (int i = 0; i < bandCount; i++)
+        {
+            int m = microsteps[i];
+            table[i].microstep = m;
+            table[i].hzPerRpm = stepsPerRevolution * m / 60.0;
+            table[i].maxRpm = maxFrequencyProduct / m / table[i].hzPerRpm;
+        }
+        return table;
+    }();
+
+    /**
+     * @brief 按转速选择档位
+     * @param rpm 转速绝对值
+     * @param current 当前档位下标，-1为无（停止后重新起步）
+     * @return 档位下标；超出最粗档上限时仍返回最粗档
+     */
+    static constexpr int select(double rpm, int current)
+    {
+        int finest = bandCount - 1;
+        int finestWithMargin = bandCount - 1;
+        for (int i = bandCount - 1; i >= 0; i--)
+        {
+            if (rpm < bands[i].maxRpm)
+                finest = i;
+            if (rpm < bands[i].maxRpm * (1.0 - hysteresis))
+                finestWithMargin = i;
+        }
+
+        // 当前档位超限时必须换更粗的档；否则只有越过回差才换更细的档
+        if (current < 0 || current >= bandCount || finest > current)
+            return finest;
+        return finestWithMargin < current ? finestWithMargin : current;
+    }
+};
+
+static_assert(StepRateTable::bands[0].microstep == 32 && StepRateTable::bands[5].microstep == 1,
+              "档位表应从最细细分排到整步");
+static_assert(StepRateTable::select(0.06, -1) == 0, "0.06 RPM 应使用32细分");
+static_assert(StepRateTable::select(9.0, 4) == 4 && StepRateTable::select(9.0, -1) == 3,
+              "回差范围内保持较粗细分");
+
+#endif // STEP_RATE_TABLE_HPP
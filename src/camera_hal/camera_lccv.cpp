@@ -86,6 +86,88 @@ namespace CameraHAL
         {
             camera.options->framerate = std::stoi(para_value);
         }
+        else if (para_name == "Transform")
+        {
+            // 传感器方向由ISP完成，只能在打开相机前设置
+            if (isOpened)
+            {
+                std::cerr << "Transform must be set before the camera is opened" << std::endl;
+                return false;
+            }
+            if (para_value == "rot180")
+            {
+                camera.options->transform = libcamera::Transform::Rot180;
+            }
+            else if (para_value == "hflip")
+            {
+                camera.options->transform = libcamera::Transform::HFlip;
+            }
+            else if (para_value == "vflip")
+            {
+                camera.options->transform = libcamera::Transform::VFlip;
+            }
+            else if (para_value == "identity")
+            {
+                camera.options->transform = libcamera::Transform::Identity;
+            }
+            else
+            {
+                std::cerr << "Unsupported transform: " << para_value << std::endl;
+                return false;
+            }
+        }
+        else if (para_name == "Crop")
+        {
+            // ISP裁剪 "x y w h"，取值0~1，坐标系为输出（已变换）图像
+            std::istringstream iss(para_value);
+            float x, y, w, h;
+            iss >> x >> y >> w >> h;
+            if (iss.fail() || w <= 0 || h <= 0 || x < 0 || y < 0 || x + w > 1.0f || y + h > 1.0f)
+            {
+                std::cerr << "Invalid crop: " << para_value << std::endl;
+                return false;
+            }
+            // ScalerCrop 使用传感器坐标，需要抵消输出方向的翻转
+            libcamera::Transform transform = camera.options->transform;
+            if (!!(transform & libcamera::Transform::HFlip))
+            {
+                x = 1.0f - x - w;
+            }
+            if (!!(transform & libcamera::Transform::VFlip))
+            {
+                y = 1.0f - y - h;
+            }
+            camera.options->roi_x = x;
+            camera.options->roi_y = y;
+            camera.options->roi_width = w;
+            camera.options->roi_height = h;
+            if (isOpened)
+            {
+                camera.ApplyZoomOptions();
+            }
+        }
+        else if (para_name == "SensorMode")
+        {
+            // "auto" 选择满足输出分辨率的最小(合并)模式，或指定 "宽 高"
+            if (para_value == "auto")
+            {
+                camera.options->sensor_mode_auto = true;
+            }
+            else
+            {
+                std::istringstream iss(para_value);
+                unsigned int width = 0, height = 0;
+                iss >> width >> height;
+                if (iss.fail())
+                {
+                    std::cerr << "Invalid sensor mode: " << para_value << std::endl;
+                    return false;
+                }
+                camera.options->sensor_mode_auto = false;
+                camera.options->sensor_mode_width = width;
+                camera.options->sensor_mode_height = height;
+            }
+        }
 
         else
         {
@@ -114,6 +196,42 @@ namespace CameraHAL
         return true;
     }
 
+    bool CameraDriver_LCCV::suspend()
+    {
+        if (!isOpened)
+        {
+            return false;
+        }
+
+        try
+        {
+            return camera.pauseVideo();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to suspend LCCV camera: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool CameraDriver_LCCV::resume()
+    {
+        if (!isOpened)
+        {
+            return false;
+        }
+
+        try
+        {
+            return camera.resumeVideo();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to resume LCCV camera: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
     bool CameraDriver_LCCV::close()
     {
         if (!isOpened)
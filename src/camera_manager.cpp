@@ -8,11 +8,37 @@
 #include <sstream>
 #include <nlohmann/json.hpp>
 #include <array>
+#include <ctime>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 using json = nlohmann::json;
 
+namespace
+{
+// 进程累计CPU时间（秒）
+double processCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
 CameraManager::CameraManager()
+    : detector_(LevelDetector::createDetector("hough"))
 {
+    // 旋转由ISP或ROI矫正映射表完成，检测器收到的总是正立的ROI
+    setRotateFrame(false);
 }
 
 CameraManager::~CameraManager()
@@ -30,12 +56,17 @@ bool CameraManager::initialize(int width, int height, int framerate)
         camera_params["Width"] = std::to_string(width);
         camera_params["Height"] = std::to_string(height);
         camera_params["Framerate"] = std::to_string(framerate);
+        // 选择满足检测分辨率的最小合并模式，降低传感器读出和ISP负载
+        camera_params["SensorMode"] = "auto";
+        // 相机倒置安装，由ISP完成180度旋转
+        camera_params["Transform"] = "rot180";
 
         if (!camera_driver_->open(camera_params))
         {
             InfusionLogger::error("无法打开相机！");
             return false;
         }
+        ispTransform_ = true;
 
         return true;
     }
@@ -53,17 +84,57 @@ void CameraManager::startProcessing()
         InfusionLogger::warn("相机处理线程已经在运行！");
         return;
     }
+    // 回收上一次运行残留的线程
+    for (auto &thread : stageThreads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    stageThreads_.clear();
+
+    processingStart_ = std::chrono::steady_clock::now();
+    processingStartCpu_ = processCpuSeconds();
+    streamingNs_ = 0;
+    streamStartNs_ = steadyNowNs();
+    wakeups_ = 0;
+    wakeLatencyNs_ = 0;
+
+    preprocessQueue_.reset();
+    detectQueue_.reset();
+    snapshotQueue_.reset();
+    shadowQueue_.reset();
+    loadShedder_.reset();
+    detectedFrames_ = 0;
 
     camera_thread_running_ = true;
-    std::thread thread(&CameraManager::cameraThread, this);
-    thread.detach(); // 分离线程
+    stageThreads_.emplace_back(&CameraManager::captureThread, this);
+    stageThreads_.emplace_back(&CameraManager::preprocessThread, this);
+    stageThreads_.emplace_back(&CameraManager::detectThread, this);
+    stageThreads_.emplace_back(&CameraManager::snapshotThread, this);
+    if (shadowDetector_)
+    {
+        stageThreads_.emplace_back(&CameraManager::shadowThread, this);
+    }
 }
 
 void CameraManager::stopProcessing()
 {
     camera_thread_running_ = false;
-    // 给线程一些时间来完成当前操作
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    // 唤醒阻塞在队列上的各级线程
+    preprocessQueue_.close();
+    detectQueue_.close();
+    snapshotQueue_.close();
+    shadowQueue_.close();
+    for (auto &thread : stageThreads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    stageThreads_.clear();
 }
 
 double CameraManager::getLiquidLevelPercentage() const
@@ -76,64 +147,530 @@ bool CameraManager::isRunning() const
     return camera_thread_running_.load();
 }
 
-void CameraManager::cameraThread()
+bool CameraManager::loadCameraCalibration(const std::string &path)
 {
-    InfusionLogger::info("相机处理线程已启动");
-    lastCalibration_ = std::chrono::steady_clock::now() - calibrationInterval_; // 保证启动时立即标定
+    if (camera_thread_running_.load())
+    {
+        InfusionLogger::warn("相机处理线程运行中，无法加载相机标定");
+        return false;
+    }
+    return rectifier_.loadCalibration(path);
+}
+
+bool CameraManager::setDetectorStrategy(const std::string &primary, const std::string &shadow, int shadowEvery)
+{
+    if (camera_thread_running_.load())
+    {
+        InfusionLogger::warn("相机处理线程运行中，无法切换检测策略");
+        return false;
+    }
+
+    auto detector = LevelDetector::createDetector(primary);
+    if (!detector)
+    {
+        InfusionLogger::error("未知的液位检测策略: {}", primary);
+        return false;
+    }
+    std::unique_ptr<LevelDetector::Detector> shadowDetector;
+    if (!shadow.empty())
+    {
+        if (shadow == primary)
+        {
+            InfusionLogger::error("影子检测策略不能与主策略相同: {}", shadow);
+            return false;
+        }
+        shadowDetector = LevelDetector::createDetector(shadow);
+        if (!shadowDetector)
+        {
+            InfusionLogger::error("未知的影子检测策略: {}", shadow);
+            return false;
+        }
+    }
+
+    detector_ = std::move(detector);
+    shadowDetector_ = std::move(shadowDetector);
+    shadowEvery_ = std::max(shadowEvery, 1);
+    InfusionLogger::info("液位检测策略: {}", detector_->name());
+    if (shadowDetector_)
+    {
+        InfusionLogger::info("影子检测策略: {}（每{}帧抽样）", shadowDetector_->name(), shadowEvery_);
+    }
+    return true;
+}
+
+CameraManager::DetectorStats CameraManager::getDetectorStats() const
+{
+    DetectorStats stats;
+    stats.primary = detector_ ? detector_->name() : "";
+    stats.shadow = shadowDetector_ ? shadowDetector_->name() : "";
+    stats.shadow_samples = shadowSamples_.load();
+    stats.shadow_failures = shadowFailures_.load();
+    if (stats.shadow_samples > 0)
+    {
+        stats.primary_latency_ms = shadowPrimaryMsSum_.load() / stats.shadow_samples;
+        stats.shadow_latency_ms = shadowMsSum_.load() / stats.shadow_samples;
+    }
+    uint64_t compared = shadowCompared_.load();
+    if (compared > 0)
+    {
+        stats.mean_disagreement = disagreementSum_.load() / compared;
+    }
+    stats.max_disagreement = disagreementMax_.load();
+    return stats;
+}
+
+LevelDetectionStats CameraManager::getLevelDetectionStats() const
+{
+    return detector_ ? detector_->trackingStats() : LevelDetectionStats();
+}
+
+void CameraManager::setProcessingBudget(std::chrono::milliseconds budget)
+{
+    loadShedder_.setBudget(budget);
+}
+
+void CameraManager::setSampleInterval(std::chrono::milliseconds interval)
+{
+    sampleIntervalMs_.store(interval.count());
+    InfusionLogger::info("液位采样间隔设置为 {} ms{}", interval.count(),
+                         interval >= dutyCycleThreshold_ ? "，启用相机占空比" : "");
+}
+
+CameraManager::DutyCycleStats CameraManager::getDutyCycleStats() const
+{
+    DutyCycleStats stats;
+    stats.duty_cycling = std::chrono::milliseconds(sampleIntervalMs_.load()) >= dutyCycleThreshold_;
+    stats.wakeups = wakeups_.load();
+    if (stats.wakeups > 0)
+    {
+        stats.avg_wake_latency_ms = wakeLatencyNs_.load() / 1e6 / stats.wakeups;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - processingStart_).count();
+    if (elapsed > 0)
+    {
+        int64_t streaming = streamingNs_.load();
+        if (!suspended_.load())
+        {
+            streaming += steadyNowNs() - streamStartNs_.load();
+        }
+        stats.streaming_ratio = std::clamp(streaming / 1e9 / elapsed, 0.0, 1.0);
+        stats.cpu_usage = (processCpuSeconds() - processingStartCpu_) / elapsed * 100.0;
+    }
+    return stats;
+}
+
+void CameraManager::sleepFor(std::chrono::steady_clock::duration duration)
+{
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (camera_thread_running_ && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            deadline - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+    }
+}
+
+std::vector<CameraManager::StageStats> CameraManager::getPipelineStats() const
+{
+    static const char *names[STAGE_COUNT] = {"capture", "preprocess", "detect", "snapshot"};
+    const FrameQueue<PipelineFrame> *queues[STAGE_COUNT] = {nullptr, &preprocessQueue_, &detectQueue_, &snapshotQueue_};
+
+    std::vector<StageStats> stats(STAGE_COUNT);
+    for (int i = 0; i < STAGE_COUNT; ++i)
+    {
+        stats[i].name = names[i];
+        if (queues[i])
+        {
+            stats[i].queue_depth = queues[i]->depth();
+            stats[i].dropped = queues[i]->dropped();
+        }
+        stats[i].processed = stageCounters_[i].processed.load();
+        stats[i].latency_ms = stageCounters_[i].latencyMs.load();
+        stats[i].wait_ms = stageCounters_[i].waitMs.load();
+        stats[i].frame_age_ms = stageCounters_[i].frameAgeMs.load();
+    }
+    return stats;
+}
+
+void CameraManager::recordStage(PipelineStage stage, const PipelineFrame &frame,
+                                 std::chrono::steady_clock::time_point start)
+{
+    // 指数滑动平均，反映最近的负载
+    constexpr double alpha = 0.1;
+    auto now = std::chrono::steady_clock::now();
+    auto ema = [alpha](std::atomic<double> &avg, double sample, bool first)
+    {
+        avg.store(first ? sample : avg.load() + alpha * (sample - avg.load()));
+    };
+
+    StageCounters &counters = stageCounters_[stage];
+    bool first = counters.processed.load() == 0;
+    ema(counters.latencyMs, std::chrono::duration<double, std::milli>(now - start).count(), first);
+    ema(counters.waitMs, stage == STAGE_CAPTURE ? 0.0 : std::chrono::duration<double, std::milli>(start - frame.enqueued).count(), first);
+    ema(counters.frameAgeMs, std::chrono::duration<double, std::milli>(now - frame.captured).count(), first);
+    counters.processed++;
+}
+
+void CameraManager::requestCrop(const cv::Rect2d &crop)
+{
+    // 同一裁剪只请求一次，避免采集线程反复下发并丢帧；下发失败时采集线程清除记录，下次重新请求
+    std::lock_guard<std::mutex> lock(cropMutex_);
+    if (crop == lastRequestedCrop_)
+    {
+        return;
+    }
+    lastRequestedCrop_ = crop;
+    requestedCrop_ = crop;
+    cropPending_ = true;
+}
+
+void CameraManager::captureThread()
+{
+    InfusionLogger::info("相机采集线程已启动");
+    ispCrop_ = cv::Rect2d(0, 0, 1, 1);
 
     while (camera_thread_running_)
     {
         try
         {
-            cv::Mat frame;
-            if (!camera_driver_->read(frame))
+            auto sampleStart = std::chrono::steady_clock::now();
+            std::chrono::milliseconds interval(sampleIntervalMs_.load());
+            if (loadShedder_.getMode() >= LoadShedder::REDUCED_FPS)
+            {
+                // 降帧率：跳过的采样计入降级帧数
+                interval *= reducedFpsDivider_;
+                loadShedder_.recordShed(reducedFpsDivider_ - 1);
+            }
+            bool dutyCycling = interval >= dutyCycleThreshold_;
+
+            // 占空比模式下按需恢复取流，AE/AWB状态已保留，仅丢弃少量预热帧
+            bool woke = false;
+            if (suspended_)
+            {
+                if (!camera_driver_->resume())
+                {
+                    InfusionLogger::error("相机恢复取流失败！");
+                    sleepFor(std::chrono::milliseconds(1000));
+                    continue;
+                }
+                suspended_ = false;
+                streamStartNs_ = steadyNowNs();
+                woke = true;
+
+                cv::Mat warmup;
+                for (int i = 0; i < warmupFrames_; ++i)
+                {
+                    camera_driver_->read(warmup);
+                }
+            }
+
+            // 下发预处理线程请求的ISP裁剪
+            bool cropChanged = false;
+            cv::Rect2d crop;
+            {
+                std::lock_guard<std::mutex> lock(cropMutex_);
+                if (cropPending_)
+                {
+                    crop = requestedCrop_;
+                    cropPending_ = false;
+                    cropChanged = true;
+                }
+            }
+            if (cropChanged)
+            {
+                std::ostringstream value;
+                value << crop.x << " " << crop.y << " " << crop.width << " " << crop.height;
+                if (camera_driver_->write("Crop", value.str()))
+                {
+                    // 控制量随后续请求下发，丢弃流水线中已排队的帧
+                    cv::Mat stale;
+                    for (int i = 0; i < cropSettleFrames_; ++i)
+                    {
+                        camera_driver_->read(stale);
+                    }
+                    ispCrop_ = crop;
+                }
+                else
+                {
+                    InfusionLogger::warn("ISP裁剪下发失败，将在下次请求时重试");
+                    std::lock_guard<std::mutex> lock(cropMutex_);
+                    lastRequestedCrop_ = cv::Rect2d(-1, -1, 0, 0);
+                }
+            }
+
+            PipelineFrame frame;
+            auto readStart = std::chrono::steady_clock::now();
+            if (!camera_driver_->read(frame.image) || frame.image.empty())
             {
                 InfusionLogger::error("无法从相机读取帧！");
                 std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 出错时稍微等待长一点
                 continue;
             }
+            frame.captured = std::chrono::steady_clock::now();
+            frame.ispCrop = ispCrop_;
+            if (woke)
+            {
+                wakeups_++;
+                wakeLatencyNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      frame.captured - sampleStart)
+                                      .count();
+            }
+            recordStage(STAGE_CAPTURE, frame, readStart);
+            frame.enqueued = std::chrono::steady_clock::now();
+            preprocessQueue_.push(std::move(frame));
+
+            if (dutyCycling)
+            {
+                // 采样间隔足够长，停止取流直到下一次采样
+                if (camera_driver_->suspend())
+                {
+                    suspended_ = true;
+                    streamingNs_ += steadyNowNs() - streamStartNs_.load();
+                }
+                sleepFor(interval - (std::chrono::steady_clock::now() - sampleStart));
+            }
+            else
+            {
+                // 控制帧率，避免过度占用CPU
+                sleepFor(interval);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            InfusionLogger::error("相机采集线程出错: {}", e.what());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // 出错时等待一秒
+        }
+    }
+
+    InfusionLogger::info("相机采集线程已停止");
+}
+
+void CameraManager::preprocessThread()
+{
+    InfusionLogger::info("相机预处理线程已启动");
+    lastCalibration_ = std::chrono::steady_clock::now() - calibrationInterval_; // 保证启动时立即标定
+    {
+        std::lock_guard<std::mutex> lock(cropMutex_);
+        lastRequestedCrop_ = cv::Rect2d(0, 0, 1, 1);
+    }
+    const cv::Rect2d fullView(0, 0, 1, 1);
+
+    while (camera_thread_running_)
+    {
+        PipelineFrame frame;
+        if (!preprocessQueue_.pop(frame, std::chrono::milliseconds(200)))
+        {
+            continue;
+        }
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+
             // 自动ROI标定
-            auto now = std::chrono::steady_clock::now();
-            if (now - lastCalibration_ >= calibrationInterval_)
+            if (start - lastCalibration_ >= calibrationInterval_)
             {
-                calibrateROI(frame);
-                lastCalibration_ = now;
-                setRoiParameters(startHeight_, endHeight_, startWidth_, endWidth_);
+                // ISP裁剪生效时先恢复全视场，标定需要完整画面
+                if (frame.ispCrop != fullView)
+                {
+                    requestCrop(fullView);
+                    continue;
+                }
+                calibrateROI(frame.image);
+                lastCalibration_ = start;
+                rectifier_.setRoi(cv::Rect2d(startWidth_, startHeight_, endWidth_ - startWidth_, endHeight_ - startHeight_));
+                applyRoi();
                 InfusionLogger::info("ROI 已标定: [{}, {}, {}, {}]", startHeight_, startWidth_, endHeight_, endWidth_);
             }
 
-            if (!frame.empty())
+            // 裁剪、旋转、去畸变和透视校正合并为一次查表重映射，只处理ROI像素；
+            // 映射表仅在ROI或帧视场变化时重建
+            cv::Mat rectified;
+            if (!rectifier_.rectify(frame.image, frame.ispCrop, !ispTransform_, rectified))
             {
-                // 假设总容量为100（可以在后续版本中参数化）
-                double percentage = detectLiquidLevelPercentage(frame, 100.0);
-                if (percentage >= 0)
+                continue;
+            }
+            frame.image = rectified;
+            frame.cpuRoi = fullView;
+
+            recordStage(STAGE_PREPROCESS, frame, start);
+            frame.enqueued = std::chrono::steady_clock::now();
+            detectQueue_.push(std::move(frame));
+        }
+        catch (const std::exception &e)
+        {
+            InfusionLogger::error("相机预处理线程出错: {}", e.what());
+        }
+    }
+
+    InfusionLogger::info("相机预处理线程已停止");
+}
+
+void CameraManager::detectThread()
+{
+    InfusionLogger::info("液位检测线程已启动");
+
+    while (camera_thread_running_)
+    {
+        PipelineFrame frame;
+        if (!detectQueue_.pop(frame, std::chrono::milliseconds(200)))
+        {
+            continue;
+        }
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            // 按当前降级模式调整检测开销
+            LoadShedder::Mode mode = loadShedder_.getMode();
+            detector_->setScale(mode >= LoadShedder::REDUCED_RESOLUTION ? reducedDetectionScale_ : 1.0);
+            detector_->setTrackingOnly(mode >= LoadShedder::TRACKING_ONLY);
+
+            cv::Mat annotated;
+            LevelDetector::Result result = detector_->detect(frame.image, frame.cpuRoi, &annotated);
+            if (result.percentage >= 0)
+            {
+                double filtered = levelFilter_.update(result.percentage);
+                liquid_level_percentage_.store(filtered);
+                if (levelCallback_)
                 {
-                    liquid_level_percentage_.store(percentage);
+                    levelCallback_(result.percentage, filtered, frame.captured);
                 }
             }
+            if (result.skipped)
+            {
+                loadShedder_.recordShed();
+            }
+
+            auto cost = std::chrono::steady_clock::now() - start;
+            loadShedder_.recordFrame(cost);
+            recordStage(STAGE_DETECT, frame, start);
+
+            // 抽样交给影子检测，队列满时丢弃旧样本，不阻塞主检测
+            if (shadowDetector_ && !result.skipped && ++detectedFrames_ % shadowEvery_ == 0)
+            {
+                PipelineFrame sample;
+                sample.image = frame.image;
+                sample.captured = frame.captured;
+                sample.enqueued = std::chrono::steady_clock::now();
+                sample.cpuRoi = frame.cpuRoi;
+                sample.level = result.percentage;
+                sample.detectMs = std::chrono::duration<double, std::milli>(cost).count();
+                shadowQueue_.push(std::move(sample));
+            }
 
-            // 控制帧率，避免过度占用CPU
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (!annotated.empty())
+            {
+                frame.image = annotated;
+                frame.enqueued = std::chrono::steady_clock::now();
+                snapshotQueue_.push(std::move(frame));
+            }
         }
         catch (const std::exception &e)
         {
-            InfusionLogger::error("相机处理线程出错: {}", e.what());
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // 出错时等待一秒
+            InfusionLogger::error("液位检测线程出错: {}", e.what());
         }
     }
 
-    InfusionLogger::info("相机处理线程已停止");
+    InfusionLogger::info("液位检测线程已停止");
+}
+
+void CameraManager::snapshotThread()
+{
+    while (camera_thread_running_)
+    {
+        PipelineFrame frame;
+        if (!snapshotQueue_.pop(frame, std::chrono::milliseconds(200)))
+        {
+            continue;
+        }
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+            // 写盘较慢，独立线程执行，不阻塞检测
+            cv::imwrite("output.jpg", frame.image);
+            recordStage(STAGE_SNAPSHOT, frame, start);
+        }
+        catch (const std::exception &e)
+        {
+            InfusionLogger::error("快照写入出错: {}", e.what());
+        }
+    }
+}
+
+void CameraManager::shadowThread()
+{
+    // 降低影子线程优先级，避免与主检测争抢CPU
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+    InfusionLogger::info("影子检测线程已启动: {}", shadowDetector_->name());
+
+    while (camera_thread_running_)
+    {
+        PipelineFrame frame;
+        if (!shadowQueue_.pop(frame, std::chrono::milliseconds(200)))
+        {
+            continue;
+        }
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+            LevelDetector::Result result = shadowDetector_->detect(frame.image, frame.cpuRoi);
+            double shadowMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            uint64_t samples = ++shadowSamples_;
+            shadowMsSum_.store(shadowMsSum_.load() + shadowMs);
+            shadowPrimaryMsSum_.store(shadowPrimaryMsSum_.load() + frame.detectMs);
+            if (frame.level >= 0 && result.percentage < 0)
+            {
+                shadowFailures_++;
+            }
+            if (frame.level >= 0 && result.percentage >= 0)
+            {
+                double disagreement = std::abs(result.percentage - frame.level);
+                shadowCompared_++;
+                disagreementSum_.store(disagreementSum_.load() + disagreement);
+                disagreementMax_.store(std::max(disagreementMax_.load(), disagreement));
+            }
+            InfusionLogger::debug("影子检测 {}: {:.1f}% ({:.1f} ms)，主检测 {}: {:.1f}% ({:.1f} ms)",
+                                  shadowDetector_->name(), result.percentage, shadowMs,
+                                  detector_->name(), frame.level, frame.detectMs);
+
+            if (samples % 100 == 0)
+            {
+                DetectorStats stats = getDetectorStats();
+                InfusionLogger::info("影子检测对比（{}帧）: {} {:.1f} ms vs {} {:.1f} ms，平均差 {:.1f}%，最大差 {:.1f}%，失败 {}",
+                                     stats.shadow_samples, stats.shadow, stats.shadow_latency_ms, stats.primary,
+                                     stats.primary_latency_ms, stats.mean_disagreement, stats.max_disagreement,
+                                     stats.shadow_failures);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            InfusionLogger::error("影子检测线程出错: {}", e.what());
+        }
+    }
+
+    InfusionLogger::info("影子检测线程已停止");
+}
+
+void CameraManager::applyRoi()
+{
+    // 优先由ISP裁剪，CPU只接收ROI像素；驱动不支持时由检测线程在CPU上裁剪
+    if (ispTransform_)
+    {
+        requestCrop(cv::Rect2d(startWidth_, startHeight_, endWidth_ - startWidth_, endHeight_ - startHeight_));
+    }
 }
 
 void CameraManager::calibrateROI(const cv::Mat &frame)
 {
     try
     {
-        // Rotate
-
-        // 旋转180度
-        cv::Mat rotatedImage;
-        cv::rotate(frame, rotatedImage, cv::ROTATE_180);
+        // ISP未旋转时在CPU上旋转180度
+        cv::Mat rotatedImage = frame;
+        if (!ispTransform_)
+        {
+            cv::rotate(frame, rotatedImage, cv::ROTATE_180);
+        }
         // 将帧保存到临时文件
         const std::string tmpFile = "/tmp/roi_calibration.jpg";
         cv::imwrite(tmpFile, rotatedImage);
@@ -0,0 +1,197 @@
+#include "flow_monitor.hpp"
+#include <algorithm>
+#include <cmath>
+
+FlowMonitor::FlowMonitor(std::chrono::seconds window)
+    : window_(static_cast<double>(std::max<long long>(window.count(), 1))),
+      ring_(capacity_)
+{
+}
+
+FlowMonitor::Alarm FlowMonitor::addSample(double level, double commandedFlow, double bottleVolume,
+                                          std::chrono::steady_clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (alarm_ != NONE)
+    {
+        return alarm_;
+    }
+    if (!hasOrigin_)
+    {
+        origin_ = time;
+        hasOrigin_ = true;
+    }
+
+    Sample sample;
+    sample.t = std::chrono::duration<double>(time - origin_).count();
+    sample.volume = level / 100.0 * bottleVolume;
+    sample.commanded = std::max(commandedFlow, 0.0);
+    if (count_ > 0 && sample.t < ring_[(head_ + count_ - 1) % capacity_].t)
+    {
+        return NONE; // 乱序样本
+    }
+
+    // 指令流量明显变化（暂停、恢复、改速）时重新开窗，窗口内指令近似恒定
+    if (count_ > 0)
+    {
+        double mean = sc_ / count_;
+        if (std::abs(sample.commanded - mean) > restartRatio_ * std::max(mean, absTolerance_))
+        {
+            head_ = 0;
+            count_ = 0;
+            pending_ = NONE;
+            rebuildSums();
+        }
+    }
+
+    // 移出超出窗口或容量的旧样本
+    while (count_ > 0 && (count_ == capacity_ || sample.t - ring_[head_].t > window_))
+    {
+        popFront();
+    }
+    push(sample);
+    if (++sinceRebuild_ >= capacity_)
+    {
+        rebuildSums();
+        sample = ring_[(head_ + count_ - 1) % capacity_]; // 时间原点已平移，取平移后的时间
+    }
+
+    Status status = evaluate();
+    if (!status.valid)
+    {
+        pending_ = NONE;
+        return NONE;
+    }
+
+    // 偏差阈值：相对/绝对容差取大，再加上斜率的统计误差
+    double diff = status.measured_flow - status.commanded_flow;
+    double threshold = std::max(relTolerance_ * status.commanded_flow, absTolerance_) + z_ * status.flow_stderr;
+    Alarm candidate = NONE;
+    if (diff < -threshold && status.commanded_flow > absTolerance_)
+    {
+        candidate = OCCLUSION;
+    }
+    else if (diff > threshold)
+    {
+        candidate = FREE_FLOW;
+    }
+
+    if (candidate != pending_)
+    {
+        pending_ = candidate;
+        pendingSince_ = sample.t;
+    }
+    if (pending_ != NONE && sample.t - pendingSince_ >= confirmTime_)
+    {
+        alarm_ = pending_;
+    }
+    return alarm_;
+}
+
+FlowMonitor::Status FlowMonitor::getStatus() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return evaluate();
+}
+
+FlowMonitor::Alarm FlowMonitor::getAlarm() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return alarm_;
+}
+
+void FlowMonitor::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    head_ = 0;
+    count_ = 0;
+    hasOrigin_ = false;
+    pending_ = NONE;
+    alarm_ = NONE;
+    rebuildSums();
+}
+
+const char *FlowMonitor::alarmName(Alarm alarm)
+{
+    switch (alarm)
+    {
+    case OCCLUSION:
+        return "occlusion";
+    case FREE_FLOW:
+        return "free_flow";
+    default:
+        return "none";
+    }
+}
+
+void FlowMonitor::push(const Sample &sample)
+{
+    ring_[(head_ + count_) % capacity_] = sample;
+    count_++;
+    sums_.add(sample.t, sample.volume);
+    sc_ += sample.commanded;
+}
+
+void FlowMonitor::popFront()
+{
+    const Sample &sample = ring_[head_];
+    sums_.remove(sample.t, sample.volume);
+    sc_ -= sample.commanded;
+    head_ = (head_ + 1) % capacity_;
+    count_--;
+}
+
+void FlowMonitor::rebuildSums()
+{
+    // 时间原点平移到窗口起点，保持t较小以减少平方项的精度损失
+    double shift = count_ > 0 ? ring_[head_].t : 0.0;
+    origin_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(shift));
+    pendingSince_ -= shift;
+
+    sums_.clear();
+    sc_ = 0.0;
+    for (size_t i = 0; i < count_; i++)
+    {
+        Sample &sample = ring_[(head_ + i) % capacity_];
+        sample.t -= shift;
+        sums_.add(sample.t, sample.volume);
+        sc_ += sample.commanded;
+    }
+    sinceRebuild_ = 0;
+}
+
+FlowMonitor::Status FlowMonitor::evaluate() const
+{
+    Status status;
+    status.alarm = alarm_;
+    status.samples = static_cast<int>(count_);
+    if (count_ > 0)
+    {
+        double newest = ring_[(head_ + count_ - 1) % capacity_].t;
+        status.updated = origin_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(newest));
+    }
+    if (count_ < static_cast<size_t>(minSamples_))
+    {
+        return status;
+    }
+
+    double span = ring_[(head_ + count_ - 1) % capacity_].t - ring_[head_].t;
+    if (span < window_ * minSpanRatio_)
+    {
+        return status;
+    }
+
+    RegressionSums::Fit fit = sums_.fit();
+    if (!fit.valid)
+    {
+        return status;
+    }
+
+    // 斜率单位ml/s，下降为负
+    status.valid = true;
+    status.measured_flow = -fit.slope * 3600.0;
+    status.commanded_flow = sc_ / static_cast<double>(count_);
+    status.flow_stderr = std::sqrt(fit.sigma2 / fit.sxx) * 3600.0;
+    return status;
+}
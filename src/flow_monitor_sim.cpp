@@ -0,0 +1,362 @@
+// 流量监测仿真：以合成液位曲线回放FlowMonitor，统计故障检测延迟与误报、流量闭环修正的精度，
+// 并检查累加量重建前后的判定一致性
+#include "flow_monitor.hpp"
+#include "flow_trim_controller.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void showHelp(const char *programName)
+{
+    cout << "用法: " << programName << " <场景>" << endl;
+    cout << "场景:" << endl;
+    cout << "  latency    堵塞与自由流的检测延迟、无故障时的误报（10Hz采样，250ml药瓶）" << endl;
+    cout << "  trim       泵增益偏差下开环与闭环修正的实际流量误差（500ml药瓶）" << endl;
+    cout << "  rebuild    同一段短时液位扰动放在普通样本处与累加量重建处，报警结果应一致" << endl;
+}
+
+static chrono::steady_clock::time_point at(chrono::steady_clock::time_point start, double seconds)
+{
+    return start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+}
+
+// 故障类型
+enum Fault
+{
+    NO_FAULT = 0,
+    OCCLUSION_FAULT, // onset起实际流量为0
+    FREE_FLOW_FAULT  // onset起实际流量为指令的3倍再加60 ml/h
+};
+
+// 按指令流量输液duration秒，返回故障后的检测延迟（秒），未报警为-1
+static double faultRun(double flow, double noisePercent, Fault fault, double onset, double duration,
+                       mt19937 &rng, FlowMonitor::Alarm &alarm)
+{
+    const double bottle = 250.0;
+    const double dt = 0.1;
+    FlowMonitor monitor;
+    normal_distribution<double> noise(0.0, noisePercent);
+    auto start = chrono::steady_clock::now();
+    double volume = 240.0;
+    alarm = FlowMonitor::NONE;
+    for (double t = 0.0; t < duration; t += dt)
+    {
+        double actual = flow;
+        if (fault != NO_FAULT && t >= onset)
+        {
+            actual = fault == OCCLUSION_FAULT ? 0.0 : flow * 3.0 + 60.0;
+        }
+        volume -= actual / 3600.0 * dt;
+        if (volume < 0)
+        {
+            break;
+        }
+        alarm = monitor.addSample(volume / bottle * 100.0 + noise(rng), flow, bottle, at(start, t));
+        if (alarm != FlowMonitor::NONE)
+        {
+            return t - onset;
+        }
+    }
+    return -1.0;
+}
+
+// 各流量与液位噪声下的检测延迟（故障起于300秒，每种50次）与1小时无故障运行的误报
+static bool latencyScenario()
+{
+    mt19937 rng(1);
+    const int runs = 50;
+    const int nominalRuns = 20;
+    bool ok = true;
+    cout << fixed << setprecision(1);
+    for (double noisePercent : {0.3, 0.5})
+    {
+        for (double flow : {20.0, 60.0, 120.0, 300.0})
+        {
+            for (Fault fault : {OCCLUSION_FAULT, FREE_FLOW_FAULT})
+            {
+                FlowMonitor::Alarm expected = fault == OCCLUSION_FAULT ? FlowMonitor::OCCLUSION : FlowMonitor::FREE_FLOW;
+                double sum = 0.0;
+                double worst = 0.0;
+                int detected = 0;
+                int wrong = 0;
+                for (int i = 0; i < runs; ++i)
+                {
+                    FlowMonitor::Alarm alarm;
+                    double latency = faultRun(flow, noisePercent, fault, 300.0, 900.0, rng, alarm);
+                    if (latency < 0 && alarm == FlowMonitor::NONE)
+                        continue;
+                    if (alarm == expected && latency >= 0)
+                    {
+                        detected++;
+                        sum += latency;
+                        worst = max(worst, latency);
+                    }
+                    else
+                    {
+                        wrong++;
+                    }
+                }
+                cout << "噪声 " << noisePercent << "% 流量 " << setw(5) << flow << " ml/h "
+                     << (fault == OCCLUSION_FAULT ? "堵塞  " : "自由流") << ": 检出 " << detected << "/" << runs
+                     << " 误判 " << wrong << " 平均 " << (detected ? sum / detected : 0.0) << " s 最大 " << worst
+                     << " s" << endl;
+                ok = ok && wrong == 0;
+            }
+
+            int falseAlarms = 0;
+            for (int i = 0; i < nominalRuns; ++i)
+            {
+                FlowMonitor::Alarm alarm;
+                faultRun(flow, noisePercent, NO_FAULT, 0.0, 3600.0, rng, alarm);
+                if (alarm != FlowMonitor::NONE)
+                {
+                    falseAlarms++;
+                }
+            }
+            cout << "噪声 " << noisePercent << "% 流量 " << setw(5) << flow << " ml/h 无故障1小时: 误报 "
+                 << falseAlarms << "/" << nominalRuns << endl;
+            ok = ok && falseAlarms == 0;
+        }
+    }
+
+    // 暂停（指令流量为0）时发生100 ml/h自由流
+    normal_distribution<double> noise(0.0, 0.5);
+    double sum = 0.0;
+    double worst = 0.0;
+    int detected = 0;
+    for (int i = 0; i < runs; ++i)
+    {
+        FlowMonitor monitor;
+        auto start = chrono::steady_clock::now();
+        double volume = 240.0;
+        for (double t = 0.0; t < 900.0; t += 0.1)
+        {
+            volume -= (t >= 300.0 ? 100.0 : 0.0) / 3600.0 * 0.1;
+            FlowMonitor::Alarm alarm = monitor.addSample(volume / 250.0 * 100.0 + noise(rng), 0.0, 250.0, at(start, t));
+            if (alarm == FlowMonitor::FREE_FLOW)
+            {
+                detected++;
+                sum += t - 300.0;
+                worst = max(worst, t - 300.0);
+            }
+            if (alarm != FlowMonitor::NONE)
+            {
+                break;
+            }
+        }
+    }
+    cout << "暂停时100 ml/h自由流: 检出 " << detected << "/" << runs << " 平均 " << (detected ? sum / detected : 0.0)
+         << " s 最大 " << worst << " s" << endl;
+
+    // 单次addSample耗时
+    FlowMonitor monitor;
+    auto start = chrono::steady_clock::now();
+    const int calls = 2000000;
+    auto begin = chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i)
+    {
+        monitor.addSample(50.0 - i * 1e-5, 60.0, 250.0, at(start, i * 0.1));
+    }
+    cout << "addSample " << chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / calls
+         << " ns" << endl;
+    return ok;
+}
+
+// 闭环仿真结果，误差均为实际流量相对目标流量，统计30分钟之后
+struct TrimResult
+{
+    double meanError;   // 平均误差
+    double worstWindow; // 最差的10分钟平均误差（绝对值）
+    double settle;      // 首次进入±2%的时间 (s)
+};
+
+// 泵的实际流量为标称曲线（6 ml/h每RPM）的gain倍；closed为false时不修正；staleFrom-staleTo之间液位样本中断
+static TrimResult trimRun(double target, double gain, double noisePercent, bool closed, mt19937 &rng,
+                          double staleFrom = -1.0, double staleTo = -1.0)
+{
+    const double bottle = 500.0;
+    const double curve = 6.0;
+    const double dt = 0.1;
+    const double duration = 7200.0;
+    FlowMonitor monitor;
+    FlowTrimController controller;
+    normal_distribution<double> noise(0.0, noisePercent);
+    auto start = chrono::steady_clock::now();
+    double volume = 490.0;
+    double openLoopRPM = target / curve;
+    double rpm = openLoopRPM;
+    double lastControl = -1.0;
+
+    TrimResult result{0.0, 0.0, -1.0};
+    double errorSum = 0.0;
+    int errorCount = 0;
+    double windowVolume = 0.0;
+    double windowTime = 0.0;
+    for (double t = 0.0; t < duration; t += dt)
+    {
+        double actual = gain * curve * rpm;
+        volume -= actual / 3600.0 * dt;
+        auto now = at(start, t);
+        if (t < staleFrom || t >= staleTo)
+        {
+            monitor.addSample(volume / bottle * 100.0 + noise(rng), curve * rpm, bottle, now);
+        }
+        // 与InfusionApp一致，1Hz运行修正
+        if (t - lastControl >= 1.0)
+        {
+            lastControl = t;
+            if (closed)
+            {
+                FlowMonitor::Status status = monitor.getStatus();
+                double trim = controller.update(target, status.measured_flow, status.valid, status.updated, now);
+                rpm = openLoopRPM * (1.0 + trim);
+            }
+        }
+        if (result.settle < 0 && abs(actual - target) / target < 0.02)
+        {
+            result.settle = t;
+        }
+        if (t >= 1800.0)
+        {
+            errorSum += (actual - target) / target;
+            errorCount++;
+            windowVolume += actual / 3600.0 * dt;
+            windowTime += dt;
+            if (windowTime >= 600.0 - 1e-9)
+            {
+                double windowError = (windowVolume / (windowTime / 3600.0) - target) / target;
+                result.worstWindow = max(result.worstWindow, abs(windowError));
+                windowVolume = 0.0;
+                windowTime = 0.0;
+            }
+        }
+    }
+    result.meanError = errorSum / errorCount;
+    return result;
+}
+
+// 各目标流量与泵增益偏差下开环与闭环的误差（液位噪声0.3%，每种10次取最差）；目标流量60 ml/h及以上闭环应在±2%内
+static bool trimScenario()
+{
+    mt19937 rng(7);
+    const int runs = 10;
+    bool ok = true;
+    cout << fixed << setprecision(2);
+    for (double target : {30.0, 60.0, 120.0, 300.0})
+    {
+        for (double gain : {0.85, 0.92, 1.08})
+        {
+            for (bool closed : {false, true})
+            {
+                double worstMean = 0.0;
+                double worstWindow = 0.0;
+                double settle = 0.0;
+                for (int i = 0; i < runs; ++i)
+                {
+                    TrimResult r = trimRun(target, gain, 0.3, closed, rng);
+                    worstMean = max(worstMean, abs(r.meanError));
+                    worstWindow = max(worstWindow, r.worstWindow);
+                    settle += r.settle;
+                }
+                cout << "目标 " << setw(6) << target << " ml/h 增益 " << gain << (closed ? " 闭环" : " 开环")
+                     << ": 平均误差 " << worstMean * 100.0 << "% 最差10分钟 " << worstWindow * 100.0 << "%";
+                if (closed)
+                {
+                    cout << " 进入±2% " << setprecision(0) << settle / runs << " s" << setprecision(2);
+                    ok = ok && (target < 60.0 || worstWindow <= 0.02);
+                }
+                cout << endl;
+            }
+        }
+    }
+
+    // 液位样本中断10分钟时回退开环
+    TrimResult stale = trimRun(60.0, 0.9, 0.3, true, rng, 3000.0, 3600.0);
+    cout << "目标 60 ml/h 增益 0.90 闭环，3000-3600 s无液位样本: 最差10分钟 " << stale.worstWindow * 100.0 << "%" << endl;
+    return ok;
+}
+
+// 100 ml/h匀速输液、10Hz采样，从第onset个样本起液位读数偏低sloshMl持续3秒（晃动）；返回报警时的样本序号，无报警为-1
+static int sloshRun(int onset, double sloshMl, FlowMonitor::Alarm &alarm)
+{
+    const double bottle = 250.0;
+    const double flow = 100.0;
+    const double dt = 0.1;
+    FlowMonitor monitor;
+    auto start = chrono::steady_clock::now();
+    double volume = 240.0;
+    for (int i = 0; i < 6000; ++i)
+    {
+        volume -= flow / 3600.0 * dt;
+        double shown = volume - (i >= onset && i < onset + 30 ? sloshMl : 0.0);
+        alarm = monitor.addSample(shown / bottle * 100.0, flow, bottle, at(start, i * dt));
+        if (alarm != FlowMonitor::NONE)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 样本容量2048，第2048个样本（序号2047）触发重建；扰动跨过该样本时结果应与远离重建处相同
+static bool rebuildScenario()
+{
+    const double sloshMl = 12.0;
+    FlowMonitor::Alarm reference;
+    int referenceAt = sloshRun(1000, sloshMl, reference);
+    cout << "扰动起于样本 1000: " << FlowMonitor::alarmName(reference) << " @ " << referenceAt << endl;
+
+    bool ok = true;
+    for (int onset : {2020, 2030, 2040, 2047})
+    {
+        FlowMonitor::Alarm alarm;
+        int alarmAt = sloshRun(onset, sloshMl, alarm);
+        bool same = alarm == reference && (alarmAt < 0) == (referenceAt < 0) &&
+                    (alarmAt < 0 || alarmAt - onset == referenceAt - 1000);
+        cout << "扰动起于样本 " << onset << ": " << FlowMonitor::alarmName(alarm) << " @ " << alarmAt
+             << (same ? "" : "  <- 与参考不一致") << endl;
+        ok = ok && same;
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+
+    InfusionLogger::init("flow_monitor_sim.log", InfusionLogger::ERROR, 1048576, 1, true, false);
+    string scenario = argv[1];
+    bool ok;
+    if (scenario == "latency")
+    {
+        ok = latencyScenario();
+    }
+    else if (scenario == "trim")
+    {
+        ok = trimScenario();
+    }
+    else if (scenario == "rebuild")
+    {
+        ok = rebuildScenario();
+    }
+    else
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+    cout << (ok ? "通过" : "失败") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include "flow_trim_controller.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cmath>
+
+double FlowTrimController::update(double targetFlow, double measuredFlow, bool measurementValid,
+                                  std::chrono::steady_clock::time_point measuredAt,
+                                  std::chrono::steady_clock::time_point now)
+{
+    // 目标流量改变后旧修正不再适用
+    if (targetFlow != lastTarget_)
+    {
+        lastTarget_ = targetFlow;
+        reset();
+    }
+    if (targetFlow <= 0)
+    {
+        fallback();
+        return 0.0;
+    }
+
+    double age = std::chrono::duration<double>(now - measuredAt).count();
+    if (!measurementValid || age > staleAfter_)
+    {
+        fallback();
+        return 0.0;
+    }
+
+    if (!closedLoop_.load())
+    {
+        closedLoop_.store(true);
+        hasStep_ = false;
+        InfusionLogger::info("流量闭环修正已启用");
+    }
+    if (hasStep_ && std::chrono::duration<double>(now - lastStep_).count() < interval_)
+    {
+        return trim_.load();
+    }
+    hasStep_ = true;
+    lastStep_ = now;
+
+    // 增量积分：实测偏低则提高转速
+    double error = (measuredFlow - targetFlow) / targetFlow;
+    double step = std::clamp(-gain_ * error, -maxStep_, maxStep_);
+    double trim = trim_.load();
+    double next = std::clamp(trim + step, -maxTrim_, maxTrim_);
+    if (next != trim - gain_ * error)
+    {
+        saturated_++;
+    }
+    trim_.store(next);
+    lastError_.store(error);
+    updates_++;
+    return next;
+}
+
+FlowTrimController::Stats FlowTrimController::getStats() const
+{
+    Stats stats;
+    stats.trim = trim_.load();
+    stats.flow_error = lastError_.load();
+    stats.closed_loop = closedLoop_.load();
+    stats.updates = updates_.load();
+    stats.saturated = saturated_.load();
+    stats.stale_fallbacks = staleFallbacks_.load();
+    return stats;
+}
+
+void FlowTrimController::reset()
+{
+    trim_.store(0.0);
+    lastError_.store(0.0);
+    closedLoop_.store(false);
+    hasStep_ = false;
+}
+
+void FlowTrimController::fallback()
+{
+    if (closedLoop_.load())
+    {
+        staleFallbacks_++;
+        InfusionLogger::warn("流量实测不可用，回退到开环转速");
+    }
+    trim_.store(0.0);
+    closedLoop_.store(false);
+    hasStep_ = false;
+}
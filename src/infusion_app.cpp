@@ -1,15 +1,21 @@
 #include "infusion_app.hpp"
 #include "logger.hpp"
 #include "sound_effect_manager.hpp"
+#include "motor_hal/motor_sim.hpp"
+#include "motor_hal/motor_sysfs_pwm.hpp"
 #include "signal_handler.hpp"
 #include "pn532.h"
 #include "pn532_rpi.h"
 #include <thread>
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <memory>
 
 // 外部声明RPC全局变量
 extern InfusionStateMachine *g_stateMachine;
+extern CameraManager *g_cameraManager;
+extern PumpCalibrator *g_pumpCalibrator;
 
 InfusionApp::InfusionApp(const std::string &pumpDataFile, const std::string &pumpName)
     : pumpDataFile_(pumpDataFile), pumpName_(pumpName)
@@ -50,12 +56,32 @@ bool InfusionApp::initialize()
         }
 
         // 初始化电机驱动器 (必须在状态机之前)
-        motorDriver_ = std::make_unique<MotorDriver>(GPIO_CHIPNAME, DIR_PIN, microPins_, MOTOR_PWM_DEVICE, pumpState_);
+        if (motorBackendName_ == "sim")
+        {
+            InfusionLogger::warn("使用仿真电机后端，不驱动实际电机");
+            motorDriver_ = std::make_unique<MotorDriver>(std::make_shared<MotorHAL::MotorBackend_Sim>(), pumpState_);
+        }
+        else if (motorBackendName_ == "sysfs")
+        {
+            motorDriver_ = std::make_unique<MotorDriver>(
+                std::make_shared<MotorHAL::MotorBackend_SysfsPwm>(GPIO_CHIPNAME, DIR_PIN, microPins_, pwmChipPath_, pwmChannel_),
+                pumpState_);
+        }
+        else
+        {
+            motorDriver_ = std::make_unique<MotorDriver>(GPIO_CHIPNAME, DIR_PIN, microPins_, MOTOR_PWM_DEVICE, pumpState_);
+        }
         if (!motorDriver_->initialize())
         {
             InfusionLogger::error("初始化电机驱动失败!");
             return false;
         }
+        // 里程计按泵数据库的转速-流量曲线折算输注量
+        motorDriver_->setFlowModel([this](double rpm)
+                                   { return PumpDatabase::calculateFlowRate(*pump_, rpm); });
+        // 脉动补偿剖面随泵数据保存
+        motorDriver_->setPulsationProfile(pump_->load()->pulsation_profile);
+        motorDriver_->setPulsationCompensation(pulsationCompensation_);
 
         // 初始化状态机
         if (!initializeStateMachine())
@@ -86,6 +112,36 @@ bool InfusionApp::initialize()
         {
             InfusionLogger::warn("初始化相机失败，继续执行...");
         }
+        cameraManager_->setSampleInterval(std::chrono::milliseconds(cameraSampleIntervalMs_));
+        cameraManager_->setProcessingBudget(std::chrono::milliseconds(visionBudgetMs_));
+        if (!cameraCalibFile_.empty() && !cameraManager_->loadCameraCalibration(cameraCalibFile_))
+        {
+            InfusionLogger::warn("相机标定加载失败，不做畸变与透视校正");
+        }
+        if (!cameraManager_->setDetectorStrategy(detectorName_, shadowDetectorName_, shadowEvery_))
+        {
+            InfusionLogger::warn("检测策略配置无效，使用默认霍夫检测");
+        }
+        // 液位写入泵状态；输液期间的原始液位送入剩余时间回归
+        cameraManager_->setLevelCallback(
+            [this](double raw, double filtered, std::chrono::steady_clock::time_point captured)
+            {
+                pumpState_.liquid_height.store(100.0 - filtered);
+                PumpControlState state = pumpState_.state.load();
+                if (state == INFUSING)
+                {
+                    remainingTimeEstimator_.addSample(100.0 - raw, captured);
+                }
+                if (state == INFUSING || state == PAUSED)
+                {
+                    flowMonitor_.addSample(100.0 - raw, commandedFlowRate(), pumpParams_.bottle_volume.load(), captured);
+                }
+                if (state == CALIBRATING && pumpCalibrator_)
+                {
+                    pumpCalibrator_->addLevelSample(100.0 - raw, captured);
+                }
+            });
+        g_cameraManager = cameraManager_.get();
 
         // 更新全局泵参数，供RPC使用
         extern PumpParams g_pumpParams;
@@ -138,6 +194,7 @@ bool InfusionApp::start()
         cameraManager_->startProcessing();
 
         // 启动电机控制线程
+        motorDriver_->setRealtimeProfile(realtimeProfile_);
         motorDriver_->startControlThread(pumpParams_, pump_params_updated_);
 
         // 启动MQTT消息处理线程
@@ -179,10 +236,15 @@ bool InfusionApp::start()
                 stateMachine_->update();
             }
 
+            // 流量闭环修正
+            updateFlowTrim();
+
             // 使用较短的睡眠周期提高响应速度
             for (int i = 0; i < 10 && running_; ++i)
             {
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                // 输出电机控制线程在实时模式下暂存的日志
+                motorDriver_->flushDeferredLogs();
             }
         }
 
@@ -207,6 +269,13 @@ void InfusionApp::stop()
     // 播放关闭音效
     playShutdownSound();
 
+    // 取消进行中的标定
+    g_pumpCalibrator = nullptr;
+    if (pumpCalibrator_)
+    {
+        pumpCalibrator_->cancel();
+    }
+
     // 首先通过状态机将泵状态设置为IDLE
     if (stateMachine_)
     {
@@ -224,6 +293,7 @@ void InfusionApp::stop()
 
     // 清空全局状态机指针
     g_stateMachine = nullptr;
+    g_cameraManager = nullptr;
 
     // 停止相机
     if (cameraManager_)
@@ -250,6 +320,54 @@ bool InfusionApp::needExit() const
     return !running_;
 }
 
+void InfusionApp::setCameraSampleInterval(int intervalMs)
+{
+    cameraSampleIntervalMs_ = intervalMs;
+}
+
+void InfusionApp::setVisionBudget(int budgetMs)
+{
+    visionBudgetMs_ = budgetMs;
+}
+
+void InfusionApp::setDetectorStrategy(const std::string &primary, const std::string &shadow, int shadowEvery)
+{
+    detectorName_ = primary;
+    shadowDetectorName_ = shadow;
+    shadowEvery_ = shadowEvery;
+}
+
+void InfusionApp::setCameraCalibration(const std::string &path)
+{
+    cameraCalibFile_ = path;
+}
+
+void InfusionApp::setFlowTrim(bool enabled)
+{
+    flowTrimEnabled_ = enabled;
+}
+
+void InfusionApp::setRealtimeProfile(const MotorDriver::RealtimeProfile &profile)
+{
+    realtimeProfile_ = profile;
+}
+
+void InfusionApp::setMotorBackend(const std::string &name)
+{
+    motorBackendName_ = name;
+}
+
+void InfusionApp::setPwmChannel(const std::string &chipPath, int channel)
+{
+    pwmChipPath_ = chipPath;
+    pwmChannel_ = channel;
+}
+
+void InfusionApp::setPulsationCompensation(bool enabled)
+{
+    pulsationCompensation_ = enabled;
+}
+
 void InfusionApp::handleSignal(int signum)
 {
     InfusionLogger::info("接收到信号 ({})，准备退出程序。", signum);
@@ -323,8 +441,8 @@ bool InfusionApp::initializePumpDatabase()
         pumpDatabase_ = std::make_unique<PumpDatabase>(pumpDataFile_);
 
         // 检查指定的泵是否存在
-        const PumpData *pumpData = pumpDatabase_->getPump(pumpName_);
-        if (!pumpData)
+        pump_ = pumpDatabase_->getHandle(pumpName_);
+        if (!pump_)
         {
             InfusionLogger::error("无法找到泵名称: {}", pumpName_);
             return false;
@@ -340,6 +458,54 @@ bool InfusionApp::initializePumpDatabase()
     }
 }
 
+double InfusionApp::commandedFlowRate()
+{
+    if (!motorDriver_ || !pump_)
+        return 0.0;
+
+    // 低于最小转速时电机实际停止
+    double speed = std::abs(motorDriver_->getSpeed());
+    if (speed <= 0.009375)
+        return 0.0;
+
+    return std::max(PumpDatabase::calculateFlowRate(*pump_, speed), 0.0);
+}
+
+void InfusionApp::updateFlowTrim()
+{
+    if (!flowTrimEnabled_ || !pump_)
+        return;
+
+    if (pumpState_.state.load() != INFUSING)
+    {
+        flowTrim_.reset();
+        pumpState_.flow_trim.store(0.0);
+        return;
+    }
+
+    double targetFlowRate = pumpParams_.target_flow_rate.load();
+    if (targetFlowRate <= 0)
+        return;
+    double openLoopRPM = PumpDatabase::calculateRPM(*pump_, targetFlowRate);
+    if (openLoopRPM <= 0)
+        return;
+
+    // 有报警时实测流量不可信，回退开环
+    FlowMonitor::Status status = flowMonitor_.getStatus();
+    double trim = flowTrim_.update(targetFlowRate, status.measured_flow,
+                                   status.valid && status.alarm == FlowMonitor::NONE,
+                                   status.updated, std::chrono::steady_clock::now());
+    pumpState_.flow_trim.store(trim);
+
+    double targetRPM = openLoopRPM * (1.0 + trim);
+    if (std::abs(targetRPM - pumpParams_.target_rpm.load()) > 1e-6)
+    {
+        pumpParams_.target_rpm.store(targetRPM);
+        pump_params_updated_.store(true);
+        motorDriver_->notify();
+    }
+}
+
 bool InfusionApp::initializeStateMachine()
 {
     InfusionLogger::info("正在初始化输液状态机...");
@@ -362,10 +528,17 @@ bool InfusionApp::initializeStateMachine()
             InfusionLogger::error("状态机初始化失败");
             return false;
         }
+        stateMachine_->setRemainingTimeEstimator(&remainingTimeEstimator_);
+        stateMachine_->setFlowMonitor(&flowMonitor_);
 
         // 设置全局状态机指针（用于RPC调用）
         g_stateMachine = stateMachine_.get();
 
+        // 现场标定程序（由RPC触发）
+        pumpCalibrator_ = std::make_unique<PumpCalibrator>(*stateMachine_, *motorDriver_, pumpParams_,
+                                                           pump_params_updated_, *pumpDatabase_, pumpName_);
+        g_pumpCalibrator = pumpCalibrator_.get();
+
         InfusionLogger::info("正在初始化PN532 NFC模块...");
 
         // 初始化PN532 NFC模块
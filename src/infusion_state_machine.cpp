@@ -1,5 +1,6 @@
 #include "infusion_state_machine.hpp"
 #include "logger.hpp"
+#include <algorithm>
 #include <chrono>
 #include <string.h>
 #include "pn532.h"
@@ -16,6 +17,7 @@ const std::string STATE_INFUSING = "INFUSING";
 const std::string STATE_PAUSED = "PAUSED";
 const std::string STATE_EMERGENCY_STOP = "EMERGENCY_STOP";
 const std::string STATE_ERROR = "ERROR";
+const std::string STATE_CALIBRATING = "CALIBRATING";
 
 // 动作名称定义
 const std::string ACTION_IDLE = "ACTION_IDLE";
@@ -26,6 +28,7 @@ const std::string ACTION_INFUSING = "ACTION_INFUSING";
 const std::string ACTION_PAUSED = "ACTION_PAUSED";
 const std::string ACTION_EMERGENCY_STOP = "ACTION_EMERGENCY_STOP";
 const std::string ACTION_ERROR = "ACTION_ERROR";
+const std::string ACTION_CALIBRATING = "ACTION_CALIBRATING";
 
 // 支持多张允许的卡UID
 #include <vector>
@@ -49,6 +52,35 @@ static bool isUidAllowed(const uint8_t* uid, int uidLen) {
     return false;
 }
 
+// 检查流量监测报警：自由流紧急停止，堵塞进入错误状态
+// 返回是否已发生状态转换
+static bool checkFlowAlarm(openfsm::OpenFSM &fsm, InfusionStateMachine::FSMContext *context)
+{
+    if (!context->flowMonitor)
+        return false;
+
+    FlowMonitor::Status status = context->flowMonitor->getStatus();
+    if (status.valid)
+        context->pumpState->measured_flow_rate.store(status.measured_flow);
+    context->pumpState->flow_alarm.store(status.alarm);
+
+    switch (status.alarm)
+    {
+    case FlowMonitor::FREE_FLOW:
+        InfusionLogger::error("检测到自由流：实测流量 {:.1f} ml/h，指令流量 {:.1f} ml/h",
+                              status.measured_flow, status.commanded_flow);
+        fsm.enterState(STATE_EMERGENCY_STOP);
+        return true;
+    case FlowMonitor::OCCLUSION:
+        InfusionLogger::error("检测到管路堵塞：实测流量 {:.1f} ml/h，指令流量 {:.1f} ml/h",
+                              status.measured_flow, status.commanded_flow);
+        fsm.enterState(STATE_ERROR);
+        return true;
+    default:
+        return false;
+    }
+}
+
 // 空闲状态动作
 class IdleAction : public openfsm::OpenFSMAction
 {
@@ -72,6 +104,14 @@ public:
         context->pumpState->state.store(IDLE);
         context->pumpState->current_flow_rate.store(0.0);
         context->pumpState->current_speed.store(0.0);
+        context->pumpState->dry_early_warning.store(false);
+
+        // 输液结束，清空液位回归样本
+        if (context->remainingTimeEstimator)
+            context->remainingTimeEstimator->reset();
+        if (context->flowMonitor)
+            context->flowMonitor->reset();
+        context->pumpState->flow_alarm.store(FlowMonitor::NONE);
 
         InfusionLogger::info("已进入空闲状态");
     }
@@ -300,9 +340,8 @@ public:
         if (!context)
             return;
 
-        // 设置电机为正向低速运行，排空气
+        // 设置电机为正向运行排空气，转速由电机控制线程按加速曲线建立
         context->motorDriver->setDirection(true); // 正向
-        context->motorDriver->setSpeed(5.0);      // 低速
 
         // 初始化准备状态计时器（5秒）
         context->preparingTimer = 5000; // 5000毫秒
@@ -379,6 +418,11 @@ public:
         if (!context)
             return;
 
+        // 排气结束，输注量从此开始计数（排气量不计入）
+        context->motorDriver->resetOdometer();
+        context->pumpState->delivered_volume.store(0.0);
+        context->pumpState->vtbi_reached.store(false);
+
         InfusionLogger::debug("正在离开准备状态");
     }
 };
@@ -403,9 +447,8 @@ public:
         double targetFlowRate = context->pumpParams->target_flow_rate.load();
         double targetRPM = context->pumpParams->target_rpm.load();
 
-        // 设置电机方向和速度
+        // 设置电机方向，转速由电机控制线程按加速曲线建立，避免起步流量冲击
         context->motorDriver->setDirection(context->pumpParams->direction.load());
-        context->motorDriver->setSpeed(targetRPM);
 
         // 更新状态
         context->pumpState->state.store(INFUSING);
@@ -448,6 +491,18 @@ public:
             return;
         }
 
+        if (checkFlowAlarm(fsm, context))
+            return;
+
+        // 电机控制线程已在达到待输注量时停止电机，这里结束输液
+        if (context->pumpState->vtbi_reached.load())
+        {
+            InfusionLogger::info("输注完成，已输注 {:.2f} ml", context->motorDriver->getOdometer().volume);
+            context->pumpState->state.store(IDLE);
+            fsm.enterState(STATE_IDLE);
+            return;
+        }
+
         // 持续输液，更新当前流量和进度
         double currentSpeed = context->motorDriver->getSpeed();
         context->pumpState->current_speed.store(currentSpeed);
@@ -460,15 +515,44 @@ public:
             double progress = 100.0 - liquidLevel;
             context->pumpState->infusion_progress.store(progress);
 
-            // 估算剩余时间（假设流量恒定）
+            // 按目标流量计划的剩余时间
             double targetFlowRate = context->pumpParams->target_flow_rate.load();
+            double plannedSeconds = -1.0;
             if (targetFlowRate > 0)
             {
-                // 假设总容量为100ml，计算剩余时间（小时）
-                double remainingVolume = liquidLevel * 1.0; // 1.0 = 总容量/100
-                double remainingHours = remainingVolume / targetFlowRate;
-                int remainingSeconds = static_cast<int>(remainingHours * 3600);
+                double remainingVolume = liquidLevel / 100.0 * context->pumpParams->bottle_volume.load();
+                plannedSeconds = remainingVolume / targetFlowRate * 3600.0;
+            }
+
+            // 优先使用液位回归的实测下降速度
+            RemainingTimeEstimator::Estimate estimate;
+            if (context->remainingTimeEstimator)
+                estimate = context->remainingTimeEstimator->estimate(std::chrono::steady_clock::now());
+
+            if (estimate.valid)
+            {
+                context->pumpState->remaining_time.store(static_cast<int>(estimate.remaining));
+                context->pumpState->remaining_time_low.store(static_cast<int>(estimate.remaining_low));
+                context->pumpState->remaining_time_high.store(static_cast<int>(estimate.remaining_high));
+
+                // 置信区间上限仍明显早于计划时间，提前预警
+                bool dryEarly = plannedSeconds > 0 &&
+                                estimate.remaining_high < plannedSeconds - std::max(plannedSeconds * 0.1, 60.0);
+                if (dryEarly && !context->pumpState->dry_early_warning.load())
+                {
+                    InfusionLogger::warn("药液预计 {:.0f} 秒后排空（95%区间 {:.0f}-{:.0f} 秒），早于计划的 {:.0f} 秒",
+                                         estimate.remaining, estimate.remaining_low, estimate.remaining_high,
+                                         plannedSeconds);
+                }
+                context->pumpState->dry_early_warning.store(dryEarly);
+            }
+            else if (plannedSeconds >= 0)
+            {
+                // 样本不足时按目标流量估算（假设流量恒定）
+                int remainingSeconds = static_cast<int>(plannedSeconds);
                 context->pumpState->remaining_time.store(remainingSeconds);
+                context->pumpState->remaining_time_low.store(remainingSeconds);
+                context->pumpState->remaining_time_high.store(remainingSeconds);
             }
         }
     }
@@ -544,7 +628,11 @@ public:
             default:
                 break;
             }
+            return;
         }
+
+        // 电机停止时液位仍下降说明存在自由流
+        checkFlowAlarm(fsm, context);
     }
 
     // 离开暂停状态
@@ -574,10 +662,8 @@ public:
         if (!context)
             return;
 
-        // 设置电机反转
-        bool currentDirection = context->pumpState->direction.load();
-        context->motorDriver->setDirection(!currentDirection);
-        context->motorDriver->setSpeed(5.0); // 低速反转
+        // 反向回抽由电机控制线程按固定步数执行，这里先立即停止正向输液
+        context->motorDriver->setSpeed(0);
 
         // 初始化紧急停止计时器（0.5秒）
         context->emergencyStopTimer = 500; // 500毫秒
@@ -586,9 +672,9 @@ public:
         // 更新状态
         context->pumpState->state.store(EMERGENCY_STOP);
         context->pumpState->current_flow_rate.store(0.0);
-        context->pumpState->current_speed.store(5.0);
+        context->pumpState->current_speed.store(0.0);
 
-        InfusionLogger::warn("已进入紧急停止状态，电机低速反转");
+        InfusionLogger::warn("已进入紧急停止状态，电机反向回抽");
 
         if (g_soundEffectManager)
             g_soundEffectManager->playSound(buzzer_autopilot_disconnect,
@@ -635,8 +721,8 @@ public:
         context->emergencyStopTimer -= elapsedMs;
         context->lastUpdateTime = now;
 
-        // 反转时间结束，停止电机并转入空闲状态
-        if (context->emergencyStopTimer <= 0)
+        // 反转时间结束且回抽完成，停止电机并转入空闲状态
+        if (context->emergencyStopTimer <= 0 && !context->motorDriver->isMoving())
         {
             context->motorDriver->setSpeed(0);
             InfusionLogger::warn("紧急停止完成，转入空闲状态");
@@ -718,6 +804,67 @@ public:
     }
 };
 
+// 标定状态动作，电机转速由PumpCalibrator通过target_rpm逐级设置
+class CalibratingAction : public openfsm::OpenFSMAction
+{
+public:
+    CalibratingAction()
+    {
+        actionName_ = ACTION_CALIBRATING;
+    }
+
+    // 进入标定状态
+    void enter(openfsm::OpenFSM &fsm) const override
+    {
+        auto *context = static_cast<InfusionStateMachine::FSMContext *>(fsm.getCustom());
+        if (!context)
+            return;
+
+        context->pumpState->state.store(CALIBRATING);
+        InfusionLogger::info("已进入标定状态");
+    }
+
+    // 标定状态更新
+    void update(openfsm::OpenFSM &fsm) const override
+    {
+        auto *context = static_cast<InfusionStateMachine::FSMContext *>(fsm.getCustom());
+        if (!context)
+            return;
+
+        context->pumpState->current_speed.store(context->motorDriver->getSpeed());
+
+        // 检查状态是否被外部更新
+        PumpControlState currentState = context->pumpState->state.load();
+        if (currentState != CALIBRATING)
+        {
+            switch (currentState)
+            {
+            case IDLE:
+                fsm.enterState(STATE_IDLE);
+                break;
+            case EMERGENCY_STOP:
+                fsm.enterState(STATE_EMERGENCY_STOP);
+                break;
+            case ERROR:
+                fsm.enterState(STATE_ERROR);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // 离开标定状态
+    void exit(openfsm::OpenFSM &fsm) const override
+    {
+        auto *context = static_cast<InfusionStateMachine::FSMContext *>(fsm.getCustom());
+        if (!context)
+            return;
+
+        InfusionLogger::debug("正在离开标定状态");
+    }
+};
+
 // 输液状态机实现
 InfusionStateMachine::InfusionStateMachine(MotorDriver &motorDriver, PumpParams &pumpParams, PumpState &pumpState)
     : motorDriver_(motorDriver), pumpParams_(pumpParams), pumpState_(pumpState)
@@ -730,6 +877,16 @@ InfusionStateMachine::InfusionStateMachine(MotorDriver &motorDriver, PumpParams
     fsmContext_.lastUpdateTime = std::chrono::steady_clock::now();
 }
 
+void InfusionStateMachine::setRemainingTimeEstimator(RemainingTimeEstimator *estimator)
+{
+    fsmContext_.remainingTimeEstimator = estimator;
+}
+
+void InfusionStateMachine::setFlowMonitor(FlowMonitor *monitor)
+{
+    fsmContext_.flowMonitor = monitor;
+}
+
 InfusionStateMachine::~InfusionStateMachine()
 {
     // 清理状态机资源
@@ -755,6 +912,7 @@ bool InfusionStateMachine::initialize()
         auto pausedState = new openfsm::OpenFSMState(static_cast<int>(PAUSED), STATE_PAUSED);
         auto emergencyStopState = new openfsm::OpenFSMState(static_cast<int>(EMERGENCY_STOP), STATE_EMERGENCY_STOP);
         auto errorState = new openfsm::OpenFSMState(static_cast<int>(ERROR), STATE_ERROR);
+        auto calibratingState = new openfsm::OpenFSMState(static_cast<int>(CALIBRATING), STATE_CALIBRATING);
 
         // 添加动作到各个状态
         idleState->addAction(new IdleAction());
@@ -765,6 +923,7 @@ bool InfusionStateMachine::initialize()
         pausedState->addAction(new PausedAction());
         emergencyStopState->addAction(new EmergencyStopAction());
         errorState->addAction(new ErrorAction());
+        calibratingState->addAction(new CalibratingAction());
 
         // 将状态添加到状态机
         fsm_->addState(idleState);
@@ -775,6 +934,7 @@ bool InfusionStateMachine::initialize()
         fsm_->addState(pausedState);
         fsm_->addState(emergencyStopState);
         fsm_->addState(errorState);
+        fsm_->addState(calibratingState);
 
         // 设置初始状态
         fsm_->enterState(STATE_IDLE);
@@ -793,7 +953,13 @@ void InfusionStateMachine::update()
 {
     if (fsm_)
     {
+        PumpControlState before = pumpState_.state.load();
         fsm_->update();
+        // 状态机内部发生转换时立即唤醒电机控制线程
+        if (pumpState_.state.load() != before)
+        {
+            motorDriver_.notify();
+        }
     }
 }
 
@@ -841,8 +1007,14 @@ void InfusionStateMachine::setState(PumpControlState state)
             case ERROR:
                 fsm_->enterState(STATE_ERROR);
                 break;
+            case CALIBRATING:
+                fsm_->enterState(STATE_CALIBRATING);
+                break;
             }
         }
+
+        // 唤醒电机控制线程立即执行新状态
+        motorDriver_.notify();
     }
 }
 
@@ -853,7 +1025,7 @@ bool InfusionStateMachine::isValidStateTransition(PumpControlState from, PumpCon
     {
     case IDLE:
         // 从IDLE可以转换到的状态
-        return (to == VERIFY_PENDING || to == PREPARING || to == ERROR);
+        return (to == VERIFY_PENDING || to == PREPARING || to == CALIBRATING || to == ERROR);
 
     case VERIFY_PENDING:
         // 从VERIFY_PENDING可以转换到的状态
@@ -883,6 +1055,10 @@ bool InfusionStateMachine::isValidStateTransition(PumpControlState from, PumpCon
         // 从ERROR只能转换到IDLE状态
         return (to == IDLE);
 
+    case CALIBRATING:
+        // 从CALIBRATING可以转换到的状态
+        return (to == IDLE || to == EMERGENCY_STOP || to == ERROR);
+
     default:
         return false;
     }
@@ -0,0 +1,53 @@
+#include "jitter_histogram.hpp"
+
+namespace
+{
+// 桶上界 (µs)，最后一个桶为 >= 20ms
+constexpr double kBounds[JitterHistogram::bucketCount - 1] = {10, 20, 50, 100, 200, 500,
+                                                                1000, 2000, 5000, 10000, 20000};
+}
+
+void JitterHistogram::record(double us)
+{
+    if (us < 0)
+        us = 0;
+
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && us >= kBounds[bucket])
+        bucket++;
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t ns = static_cast<uint64_t>(us * 1000.0);
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    sumNs_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = maxNs_.load(std::memory_order_relaxed);
+    while (ns > prev && !maxNs_.compare_exchange_weak(prev, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+JitterHistogram::Snapshot JitterHistogram::snapshot() const
+{
+    Snapshot snapshot;
+    for (int i = 0; i < bucketCount; i++)
+        snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+    snapshot.samples = samples_.load(std::memory_order_relaxed);
+    if (snapshot.samples > 0)
+        snapshot.mean_us = sumNs_.load(std::memory_order_relaxed) / 1000.0 / snapshot.samples;
+    snapshot.max_us = maxNs_.load(std::memory_order_relaxed) / 1000.0;
+    return snapshot;
+}
+
+void JitterHistogram::reset()
+{
+    for (auto &count : counts_)
+        count.store(0, std::memory_order_relaxed);
+    samples_.store(0, std::memory_order_relaxed);
+    sumNs_.store(0, std::memory_order_relaxed);
+    maxNs_.store(0, std::memory_order_relaxed);
+}
+
+double JitterHistogram::bucketUpperBound(int i)
+{
+    return i >= 0 && i < bucketCount - 1 ? kBounds[i] : -1.0;
+}
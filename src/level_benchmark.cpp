@@ -0,0 +1,163 @@
+// 液位检测策略离线回放基准：对同一组图片逐帧运行各策略，统计耗时与相对首个策略的差异
+#include <level_detector/level_detector.hpp>
+#include "liquid_detector.hpp"
+#include "logger.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void showHelp(const char *programName)
+{
+    cout << "用法: " << programName << " <图片目录> <策略1>[,策略2...] [选项]" << endl;
+    cout << "策略: hough, gradient, hsv, cnn[:模型路径]" << endl;
+    cout << "选项:" << endl;
+    cout << "  --roi=X,Y,W,H   检测区域（相对比例，默认 0,0.1,1,0.6）" << endl;
+    cout << "  --batch=N       同一帧重复N个ROI走批量路径（默认: 1）" << endl;
+    cout << "  --rotate        图片未经ISP旋转，需在CPU上旋转180度" << endl;
+}
+
+static double percentile(vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    sort(values.begin(), values.end());
+    size_t idx = min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    return values[idx];
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+
+    string imageDir = argv[1];
+    vector<string> strategies;
+    stringstream ss(argv[2]);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        strategies.push_back(item);
+    }
+
+    cv::Rect2d roi(0.0, 0.1, 1.0, 0.6);
+    int batch = 1;
+    bool rotate = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.find("--roi=") == 0)
+        {
+            char comma;
+            stringstream rs(arg.substr(6));
+            rs >> roi.x >> comma >> roi.y >> comma >> roi.width >> comma >> roi.height;
+        }
+        else if (arg.find("--batch=") == 0)
+        {
+            batch = max(1, atoi(arg.substr(8).c_str()));
+        }
+        else if (arg == "--rotate")
+        {
+            rotate = true;
+        }
+        else
+        {
+            showHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    InfusionLogger::init("level_benchmark.log", InfusionLogger::WARN, 1048576, 1, true, false);
+    setRotateFrame(rotate);
+
+    vector<cv::String> files;
+    cv::glob(imageDir + "/*.jpg", files);
+    vector<cv::Mat> frames;
+    for (const auto &file : files)
+    {
+        cv::Mat frame = cv::imread(file);
+        if (!frame.empty())
+        {
+            frames.push_back(frame);
+        }
+    }
+    if (frames.empty())
+    {
+        cerr << "目录中没有可用的jpg图片: " << imageDir << endl;
+        return 1;
+    }
+    cout << "回放 " << frames.size() << " 帧，ROI数 " << batch << endl;
+
+    vector<cv::Rect2d> rois(batch, roi);
+    vector<double> reference;
+    cout << left << setw(20) << "策略" << setw(10) << "均值ms" << setw(10) << "P50ms" << setw(10) << "P95ms"
+         << setw(10) << "最大ms" << setw(10) << "失败" << setw(12) << "平均差%" << endl;
+
+    for (const auto &name : strategies)
+    {
+        auto detector = LevelDetector::createDetector(name);
+        if (!detector)
+        {
+            cerr << "无法创建策略: " << name << endl;
+            continue;
+        }
+
+        // 预热
+        for (size_t i = 0; i < min<size_t>(3, frames.size()); ++i)
+        {
+            detector->detectBatch(frames[i], rois);
+        }
+
+        vector<double> latencies;
+        vector<double> levels;
+        int failures = 0;
+        for (const auto &frame : frames)
+        {
+            auto start = chrono::steady_clock::now();
+            vector<LevelDetector::Result> results = batch > 1 ? detector->detectBatch(frame, rois)
+                                                               : vector<LevelDetector::Result>{detector->detect(frame, roi)};
+            latencies.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / batch);
+            levels.push_back(results.front().percentage);
+            if (results.front().percentage < 0)
+            {
+                failures++;
+            }
+        }
+
+        // 与第一个策略逐帧比较
+        double diffSum = 0.0;
+        int compared = 0;
+        if (reference.empty())
+        {
+            reference = levels;
+        }
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            if (levels[i] >= 0 && reference[i] >= 0)
+            {
+                diffSum += abs(levels[i] - reference[i]);
+                compared++;
+            }
+        }
+
+        double mean = 0.0;
+        for (double l : latencies)
+            mean += l;
+        mean /= latencies.size();
+        cout << left << setw(20) << name << fixed << setprecision(2) << setw(10) << mean << setw(10)
+             << percentile(latencies, 0.5) << setw(10) << percentile(latencies, 0.95) << setw(10)
+             << percentile(latencies, 1.0) << setw(10) << failures << setw(12)
+             << (compared ? diffSum / compared : 0.0) << endl;
+    }
+    return 0;
+}
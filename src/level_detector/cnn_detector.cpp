@@ -0,0 +1,150 @@
+/**
+ * @file cnn_detector.cpp
+ * @note CNN液位线回归检测策略
+ */
+#include <level_detector/cnn_detector.hpp>
+#include "liquid_detector.hpp"
+#include "logger.hpp"
+#include <cmath>
+
+namespace LevelDetector
+{
+    CnnDetector::CnnDetector(const std::string &modelPath, int maxBatch)
+        : maxBatch_(std::max(maxBatch, 1))
+    {
+        try
+        {
+            net_ = cv::dnn::readNet(modelPath);
+            net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+            net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+            loaded_ = !net_.empty();
+        }
+        catch (const cv::Exception &e)
+        {
+            InfusionLogger::error("加载CNN液位模型失败 {}: {}", modelPath, e.what());
+            loaded_ = false;
+        }
+
+        const int shape[] = {maxBatch_, 1, inputHeight_, inputWidth_};
+        blob_.create(4, shape, CV_32F);
+        gray_.create(inputHeight_, inputWidth_, CV_8UC1);
+
+        if (loaded_)
+        {
+            // 预热一次，让DNN完成层初始化和内存分配
+            blob_.setTo(0);
+            std::vector<Result> results;
+            infer(1, results);
+            InfusionLogger::info("CNN液位模型已加载: {}", modelPath);
+        }
+    }
+
+    bool CnnDetector::fillInput(const cv::Mat &image, const cv::Rect2d &roi, int index)
+    {
+        if (image.empty() ||
+            !cropLevelRoi(image, roi.y, roi.y + roi.height, roi.x, roi.x + roi.width, scale_, cropped_))
+        {
+            return false;
+        }
+
+        // 直接写入预分配blob的对应平面
+        cv::resize(cropped_, resized_, cv::Size(inputWidth_, inputHeight_), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(resized_, gray_, cv::COLOR_BGR2GRAY);
+        cv::Mat plane(inputHeight_, inputWidth_, CV_32F, blob_.ptr<float>(index));
+        gray_.convertTo(plane, CV_32F, 1.0 / 255.0);
+        return true;
+    }
+
+    void CnnDetector::infer(int count, std::vector<Result> &results)
+    {
+        // 使用blob前count个平面，不拷贝数据
+        const int shape[] = {count, 1, inputHeight_, inputWidth_};
+        cv::Mat input(4, shape, CV_32F, blob_.data);
+        net_.setInput(input);
+        net_.forward(outputs_);
+
+        cv::Mat output = outputs_.front().reshape(1, count);
+        for (int i = 0; i < count; ++i)
+        {
+            Result result;
+            double row = output.at<float>(i, 0);
+            bool confident = true;
+            if (output.cols >= 2)
+            {
+                double logit = output.at<float>(i, 1);
+                confident = 1.0 / (1.0 + std::exp(-logit)) >= minConfidence_;
+            }
+            if (confident && std::isfinite(row))
+            {
+                result.percentage = std::clamp(row * 100.0, 0.0, 100.0);
+            }
+            results.push_back(result);
+        }
+    }
+
+    Result CnnDetector::detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated)
+    {
+        if (!loaded_ || !fillInput(image, roi, 0))
+        {
+            return Result();
+        }
+
+        std::vector<Result> results;
+        infer(1, results);
+        Result result = results.front();
+
+        if (annotated)
+        {
+            *annotated = cropped_.clone();
+            if (result.percentage >= 0)
+            {
+                int row = static_cast<int>(result.percentage / 100.0 * cropped_.rows);
+                cv::line(*annotated, cv::Point(0, row), cv::Point(cropped_.cols - 1, row), cv::Scalar(0, 255, 0), 2);
+            }
+            cv::putText(*annotated, "Percentage: " + std::to_string(result.percentage) + "%", cv::Point(10, 30),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 2);
+        }
+        return result;
+    }
+
+    std::vector<Result> CnnDetector::detectBatch(const cv::Mat &image, const std::vector<cv::Rect2d> &rois)
+    {
+        std::vector<Result> results;
+        results.reserve(rois.size());
+        if (!loaded_)
+        {
+            results.resize(rois.size());
+            return results;
+        }
+
+        // 按最大批量分组推理，裁剪失败的ROI单独标记为失败
+        size_t begin = 0;
+        while (begin < rois.size())
+        {
+            size_t end = std::min(rois.size(), begin + static_cast<size_t>(maxBatch_));
+            std::vector<bool> valid(end - begin);
+            int count = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                valid[i - begin] = fillInput(image, rois[i], count);
+                if (valid[i - begin])
+                {
+                    count++;
+                }
+            }
+
+            std::vector<Result> batch;
+            if (count > 0)
+            {
+                infer(count, batch);
+            }
+            size_t next = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                results.push_back(valid[i - begin] ? batch[next++] : Result());
+            }
+            begin = end;
+        }
+        return results;
+    }
+} // namespace LevelDetector
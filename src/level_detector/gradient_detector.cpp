@@ -0,0 +1,54 @@
+/**
+ * @file gradient_detector.cpp
+ * @note 梯度剖面液位检测策略
+ */
+#include <level_detector/gradient_detector.hpp>
+#include "liquid_detector.hpp"
+
+namespace LevelDetector
+{
+    Result GradientDetector::detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated)
+    {
+        Result result;
+        cv::Mat cropped;
+        if (image.empty() ||
+            !cropLevelRoi(image, roi.y, roi.y + roi.height, roi.x, roi.x + roi.width, scale_, cropped))
+        {
+            return result;
+        }
+
+        // 竖直梯度按行平均得到剖面，液面处亮度沿竖直方向突变
+        cv::cvtColor(cropped, gray_, cv::COLOR_BGR2GRAY);
+        cv::GaussianBlur(gray_, gray_, cv::Size(5, 5), 0);
+        cv::Sobel(gray_, gradY_, CV_32F, 0, 1, 3);
+        gradY_ = cv::abs(gradY_);
+        cv::reduce(gradY_, profile_, 1, cv::REDUCE_AVG, CV_32F);
+        cv::GaussianBlur(profile_, profile_, cv::Size(1, 7), 0);
+
+        // 忽略边缘几行，避免裁剪边界的伪梯度
+        const int margin = 2;
+        if (profile_.rows <= 2 * margin)
+        {
+            return result;
+        }
+        double maxVal = 0.0;
+        cv::Point maxLoc;
+        cv::minMaxLoc(profile_.rowRange(margin, profile_.rows - margin), nullptr, &maxVal, nullptr, &maxLoc);
+        if (maxVal < minContrast_)
+        {
+            return result;
+        }
+
+        int row = maxLoc.y + margin;
+        result.percentage = std::clamp(row * 100.0 / cropped.rows, 0.0, 100.0);
+
+        if (annotated)
+        {
+            *annotated = cropped.clone();
+            cv::line(*annotated, cv::Point(0, row), cv::Point(cropped.cols - 1, row), cv::Scalar(0, 255, 0), 2);
+            cv::putText(*annotated, "Percentage: " + std::to_string(result.percentage) + "%", cv::Point(10, 30),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 2);
+        }
+        return result;
+    }
+} // namespace LevelDetector
@@ -0,0 +1,31 @@
+/**
+ * @file hough_detector.cpp
+ * @note 霍夫直线液位检测策略
+ */
+#include <level_detector/hough_detector.hpp>
+
+namespace LevelDetector
+{
+    Result HoughDetector::detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated)
+    {
+        tracker_.setRoi(roi.y, roi.y + roi.height, roi.x, roi.x + roi.width);
+        tracker_.setScale(scale_);
+
+        uint64_t skippedBefore = tracker_.stats().skipped_frames;
+        Result result;
+        // 假设总容量为100（可以在后续版本中参数化）
+        result.percentage = detectLiquidLevelPercentage(image, tracker_, 100.0, annotated);
+        result.skipped = tracker_.stats().skipped_frames != skippedBefore;
+        return result;
+    }
+
+    void HoughDetector::setTrackingOnly(bool enabled)
+    {
+        tracker_.setTrackingOnly(enabled);
+    }
+
+    LevelDetectionStats HoughDetector::trackingStats() const
+    {
+        return tracker_.stats();
+    }
+} // namespace LevelDetector
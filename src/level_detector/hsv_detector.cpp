@@ -0,0 +1,64 @@
+/**
+ * @file hsv_detector.cpp
+ * @note HSV颜色分割液位检测策略
+ */
+#include <level_detector/hsv_detector.hpp>
+#include "liquid_detector.hpp"
+
+namespace LevelDetector
+{
+    void HsvDetector::setRange(const cv::Scalar &lower, const cv::Scalar &upper)
+    {
+        lower_ = lower;
+        upper_ = upper;
+    }
+
+    Result HsvDetector::detect(const cv::Mat &image, const cv::Rect2d &roi, cv::Mat *annotated)
+    {
+        Result result;
+        cv::Mat cropped;
+        if (image.empty() ||
+            !cropLevelRoi(image, roi.y, roi.y + roi.height, roi.x, roi.x + roi.width, scale_, cropped))
+        {
+            return result;
+        }
+
+        cv::cvtColor(cropped, hsv_, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv_, lower_, upper_, mask_);
+        cv::reduce(mask_, rowCoverage_, 1, cv::REDUCE_AVG, CV_32F);
+
+        // 自上而下找到连续若干行液体占满的位置
+        int run = 0;
+        int top = -1;
+        for (int r = 0; r < rowCoverage_.rows; ++r)
+        {
+            if (rowCoverage_.at<float>(r, 0) / 255.0 >= minRowCoverage_)
+            {
+                if (++run >= minLiquidRows_)
+                {
+                    top = r - run + 1;
+                    break;
+                }
+            }
+            else
+            {
+                run = 0;
+            }
+        }
+        if (top < 0)
+        {
+            return result;
+        }
+
+        result.percentage = std::clamp(top * 100.0 / cropped.rows, 0.0, 100.0);
+
+        if (annotated)
+        {
+            *annotated = cropped.clone();
+            cv::line(*annotated, cv::Point(0, top), cv::Point(cropped.cols - 1, top), cv::Scalar(0, 255, 0), 2);
+            cv::putText(*annotated, "Percentage: " + std::to_string(result.percentage) + "%", cv::Point(10, 30),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 2);
+        }
+        return result;
+    }
+} // namespace LevelDetector
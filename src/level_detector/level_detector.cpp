@@ -0,0 +1,68 @@
+/**
+ * @file level_detector.cpp
+ * @note 液位检测策略工厂与输出滤波
+ */
+#include <level_detector/level_detector.hpp>
+#include <level_detector/hough_detector.hpp>
+#include <level_detector/gradient_detector.hpp>
+#include <level_detector/hsv_detector.hpp>
+#include <level_detector/cnn_detector.hpp>
+
+namespace LevelDetector
+{
+    // CNN模型默认路径
+    static const char *defaultCnnModel = "models/meniscus_int8.onnx";
+
+    double LevelFilter::update(double raw)
+    {
+        // 升高时直接更新，降低时需要保持
+        if (raw > last_)
+        {
+            // 低通滤波缓慢上升
+            filtered_ = alpha_ * raw + (1 - alpha_) * filtered_;
+            holdCount_ = 0;
+        }
+        else
+        {
+            if (holdCount_ < holdLimit_)
+            {
+                holdCount_++;
+                // 保持不变
+            }
+            else
+            {
+                // 低通滤波缓慢下降
+                filtered_ = alpha_ * raw + (1 - alpha_) * filtered_;
+            }
+        }
+        last_ = filtered_;
+        return std::clamp(filtered_, 0.0, 100.0);
+    }
+
+    std::unique_ptr<Detector> createDetector(const std::string &name)
+    {
+        if (name == "hough")
+        {
+            return std::make_unique<HoughDetector>();
+        }
+        if (name == "gradient")
+        {
+            return std::make_unique<GradientDetector>();
+        }
+        if (name == "hsv")
+        {
+            return std::make_unique<HsvDetector>();
+        }
+        if (name == "cnn" || name.rfind("cnn:", 0) == 0)
+        {
+            std::string modelPath = name.size() > 4 ? name.substr(4) : defaultCnnModel;
+            auto detector = std::make_unique<CnnDetector>(modelPath);
+            if (!detector->isLoaded())
+            {
+                return nullptr;
+            }
+            return detector;
+        }
+        return nullptr;
+    }
+} // namespace LevelDetector
@@ -5,19 +5,27 @@
 #include <vector>
 #include <algorithm>
 #include <numeric>
+#include <atomic>
+#include <chrono>
 
 using namespace cv;
 using namespace std;
 
-// === 全局变量：控制裁剪区域 ===
-double startHeight = 0.1;
-double endHeight = 0.7;
-double startWidth = 0.0;
-double endWidth = 1.0;
+// 是否需要在CPU上旋转180度（ISP完成旋转时关闭）
+bool rotateFrame = true;
 
 double canny_thr_0 = 40;
 double canny_thr_1 = 60;
 
+// === 液位线跟踪（状态见LevelTracker） ===
+const int fullScanIterations = 50;   // 全图扫描的霍夫检测次数
+const int trackIterations = 10;      // 跟踪窗口的霍夫检测次数
+const int trackBandMin = 24;         // 跟踪窗口半高下限（像素），需大于膨胀核高度
+const double trackBandRatio = 0.08;  // 跟踪窗口半高占裁剪图高度比例
+const double minTrackConfidence = 0.6; // 低于该置信度视为跟丢
+const int maxTrackedFrames = 100;    // 连续跟踪帧数上限，到达后强制全图扫描防止漂移
+const int maxSkippedLosses = 3;      // 仅跟踪模式下连续跟丢超过该次数后仍做一次全图扫描重新捕获
+
 // 液位检测辅助函数（霍夫线检测）
 Vec4i detectLiquidLevelLine(const Mat &edgeImage)
 {
@@ -71,76 +79,124 @@ double simulation_function(double x)
     return a * x * x * x + b * x * x + c * x + d;
 }
 
-void setRoiParameters(double startH, double endH, double startW, double endW)
+void LevelTracker::setRoi(double startH, double endH, double startW, double endW)
 {
-    startHeight = startH;
-    endHeight = endH;
-    startWidth = startW;
-    endWidth = endW;
+    if (startH != startHeight_ || endH != endHeight_ || startW != startWidth_ || endW != endWidth_)
+    {
+        // 裁剪区域变化后上一帧的液位线位置不再有效
+        reset();
+    }
+    startHeight_ = startH;
+    endHeight_ = endH;
+    startWidth_ = startW;
+    endWidth_ = endW;
 }
 
-#include <map>
-#include <cmath>
+void LevelTracker::setTrackingEnabled(bool enabled)
+{
+    trackingEnabled_ = enabled;
+    reset();
+}
 
-// 液位检测主函数（多次检测+分桶+中位平均）
-double detectLiquidLevelPercentage(const Mat &inputImage, double totalVolume)
+void LevelTracker::setScale(double scale)
 {
-    if (inputImage.empty())
+    scale_ = std::clamp(scale, 0.1, 1.0);
+}
+
+void LevelTracker::setTrackingOnly(bool enabled)
+{
+    trackingOnly_ = enabled;
+}
+
+void LevelTracker::reset()
+{
+    trackedRow_ = -1;
+    framesSinceFullScan_ = 0;
+    consecutiveLosses_ = 0;
+}
+
+LevelDetectionStats LevelTracker::stats() const
+{
+    LevelDetectionStats stats;
+    stats.tracked_frames = trackedFrames_.load();
+    stats.full_scans = fullScans_.load();
+    stats.track_losses = trackLosses_.load();
+    stats.skipped_frames = skippedFrames_.load();
+    uint64_t total = stats.tracked_frames + stats.full_scans;
+    if (total > 0)
     {
-        InfusionLogger::error("输入图像为空，检测失败。");
-        return -1.0;
+        stats.tracked_ratio = static_cast<double>(stats.tracked_frames) / total;
     }
+    if (stats.tracked_frames > 0)
+    {
+        stats.tracked_latency_ms = trackedLatencyNs_.load() / 1e6 / stats.tracked_frames;
+    }
+    if (stats.full_scans > 0)
+    {
+        stats.full_scan_latency_ms = fullScanLatencyNs_.load() / 1e6 / stats.full_scans;
+    }
+    return stats;
+}
 
-    // 将图像调整为固定大小
-    Mat resizedImage;
-    resize(inputImage, resizedImage, Size(640, 480));
+void setRotateFrame(bool rotate)
+{
+    rotateFrame = rotate;
+}
 
-    // 旋转180度
-    Mat rotatedImage;
-    rotate(resizedImage, rotatedImage, ROTATE_180);
+#include <map>
+#include <cmath>
 
-    int width = rotatedImage.cols;
-    int height = rotatedImage.rows;
+// 行带扫描结果
+struct LevelScanResult
+{
+    double percentage = -1.0; // 相对整幅裁剪图的液位占比
+    double confidence = 0.0;  // 与结果一致的检测次数占比
+};
 
-    if (startHeight >= endHeight || startWidth >= endWidth)
+// 在裁剪图的[rowBegin, rowEnd)行带内多次霍夫检测（多次检测+分桶+中位平均）
+// missAsZero为true时未检测到液位线记为0%（全图扫描的原有行为），否则忽略
+LevelScanResult scanLevelBand(const Mat &croppedImage, int rowBegin, int rowEnd, int iterations, bool missAsZero)
+{
+    LevelScanResult result;
+    const int cropHeight = croppedImage.rows;
+    rowBegin = std::clamp(rowBegin, 0, cropHeight);
+    rowEnd = std::clamp(rowEnd, rowBegin, cropHeight);
+    if (rowEnd - rowBegin <= 0)
     {
-        InfusionLogger::error("裁剪参数设置错误（start应小于end）");
-        return -1.0;
+        return result;
     }
 
-    int cropX = static_cast<int>(width * startWidth);
-    int cropY = static_cast<int>(height * startHeight);
-    int cropWidth = static_cast<int>(width * (endWidth - startWidth));
-    int cropHeight = static_cast<int>(height * (endHeight - startHeight));
-    Rect roi(cropX, cropY, cropWidth, cropHeight);
+    // 边缘图是确定性的，只计算一次；霍夫检测带随机性，重复多次
+    Mat band = croppedImage.rowRange(rowBegin, rowEnd);
+    Mat gray, edges;
+    cvtColor(band, gray, COLOR_BGR2GRAY);
+    Canny(gray, edges, canny_thr_0, canny_thr_1);
 
-    Mat croppedImage = rotatedImage(roi);
+    // 膨胀
+    Mat dilatedEdges;
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(15, 8));
+    dilate(edges, dilatedEdges, kernel);
 
     std::vector<double> percentages;
-
-    for (int i = 0; i < 50; ++i)
+    std::vector<double> hits;
+    for (int i = 0; i < iterations; ++i)
     {
-        Mat gray, edges;
-        cvtColor(croppedImage, gray, COLOR_BGR2GRAY);
-        Canny(gray, edges, canny_thr_0, canny_thr_1);
-
-        // 膨胀
-        Mat dilatedEdges;
-        Mat kernel = getStructuringElement(MORPH_RECT, Size(15, 8));
-        dilate(edges, dilatedEdges, kernel);
-
         Vec4i levelLine = detectLiquidLevelLine(dilatedEdges);
 
         if (levelLine == Vec4i(0, 0, 0, 0))
         {
-            percentages.push_back(0.0);
+            if (missAsZero)
+            {
+                percentages.push_back(0.0);
+            }
             continue;
         }
 
-        int midY = (levelLine[1] + levelLine[3]) / 2;
+        int midY = rowBegin + (levelLine[1] + levelLine[3]) / 2;
         int distanceToBottom = cropHeight - midY;
         double raw_percentage = (1 - distanceToBottom / static_cast<double>(cropHeight)) * 100.0;
         percentages.push_back(std::clamp(raw_percentage, 0.0, 100.0));
+        hits.push_back(percentages.back());
     }
 
     // 分桶，相差不超过5为一桶
@@ -177,51 +233,173 @@ double detectLiquidLevelPercentage(const Mat &inputImage, double totalVolume)
 
     if (bucket_averages.empty())
     {
-        InfusionLogger::debug("未检测到有效液位线。");
-        return -1.0;
+        return result;
     }
 
     // 取平均后的中位数作为最终结果
     std::sort(bucket_averages.begin(), bucket_averages.end());
-    double final_result;
     size_t n = bucket_averages.size();
     if (n % 2 == 1)
-        final_result = bucket_averages[n / 2];
+        result.percentage = bucket_averages[n / 2];
     else
-        final_result = (bucket_averages[n / 2 - 1] + bucket_averages[n / 2]) / 2.0;
+        result.percentage = (bucket_averages[n / 2 - 1] + bucket_averages[n / 2]) / 2.0;
 
-    double raw_percentage = final_result;
-    static double last_percentage = 0.0;
-    static double filtered_percentage = 0.0;
-    static int hold_count = 0;
-    static const int hold_limit = 5; // 保持次数限制
-    double alpha = 0.1;              // 低通滤波系数
+    // 置信度：实际检测到且与结果相差不超过5的次数占比
+    size_t agree = std::count_if(hits.begin(), hits.end(), [&](double p)
+                                 { return std::abs(p - result.percentage) <= 5.0; });
+    result.confidence = static_cast<double>(agree) / iterations;
+    return result;
+}
 
-    // 升高时直接更新，降低时需要保持
-    if (raw_percentage > last_percentage)
+bool cropLevelRoi(const Mat &inputImage, double startH, double endH, double startW, double endW, double scale,
+                  Mat &croppedImage)
+{
+    if (startH >= endH || startW >= endW)
     {
-        // 低通滤波缓慢上升
-        filtered_percentage = alpha * raw_percentage + (1 - alpha) * filtered_percentage;
-        hold_count = 0;
+        InfusionLogger::error("裁剪参数设置错误（start应小于end）");
+        return false;
     }
-    else
+
+    // ROI定义在旋转后的图像中；先在原图上裁剪，只缩放和旋转ROI像素
+    double roiX = startW;
+    double roiY = startH;
+    if (rotateFrame)
     {
-        if (hold_count < hold_limit)
-        {
-            hold_count++;
-            // 保持不变
-        }
-        else
+        roiX = 1.0 - endW;
+        roiY = 1.0 - endH;
+    }
+    Rect srcRoi(cvRound(roiX * inputImage.cols), cvRound(roiY * inputImage.rows),
+                cvRound((endW - startW) * inputImage.cols), cvRound((endH - startH) * inputImage.rows));
+    srcRoi &= Rect(0, 0, inputImage.cols, inputImage.rows);
+    if (srcRoi.empty())
+    {
+        InfusionLogger::error("裁剪区域超出图像范围");
+        return false;
+    }
+
+    // 按ROI原始像素尺寸检测（640x480帧时与原先一致），降级时再按比例缩小；
+    // 已矫正的ROI图像不会被放大
+    int cropWidth = cvRound(srcRoi.width * scale);
+    int cropHeight = cvRound(srcRoi.height * scale);
+    if (cropWidth <= 0 || cropHeight <= 0)
+    {
+        InfusionLogger::error("裁剪区域过小");
+        return false;
+    }
+
+    croppedImage = inputImage(srcRoi);
+    if (croppedImage.size() != Size(cropWidth, cropHeight))
+    {
+        Mat resizedImage;
+        resize(croppedImage, resizedImage, Size(cropWidth, cropHeight));
+        croppedImage = resizedImage;
+    }
+    if (rotateFrame)
+    {
+        Mat rotatedImage;
+        rotate(croppedImage, rotatedImage, ROTATE_180);
+        croppedImage = rotatedImage;
+    }
+    return true;
+}
+
+// 液位检测主函数（多次检测+分桶+中位平均），返回未滤波的液位占比
+double detectLiquidLevelPercentage(const Mat &inputImage, LevelTracker &tracker, double totalVolume,
+                                   Mat *annotatedImage)
+{
+    if (inputImage.empty())
+    {
+        InfusionLogger::error("输入图像为空，检测失败。");
+        return -1.0;
+    }
+
+    Mat croppedImage;
+    if (!cropLevelRoi(inputImage, tracker.startHeight_, tracker.endHeight_, tracker.startWidth_, tracker.endWidth_,
+                      tracker.scale_, croppedImage))
+    {
+        return -1.0;
+    }
+    const int cropHeight = croppedImage.rows;
+
+    // 优先在上一次液位线附近的窄带内跟踪，跟丢或置信度低时退回全图扫描
+    auto scanStart = std::chrono::steady_clock::now();
+    if (tracker.trackedCropHeight_ != cropHeight)
+    {
+        tracker.reset();
+        tracker.trackedCropHeight_ = cropHeight;
+    }
+
+    LevelScanResult scan;
+    bool tracked = false;
+    if (tracker.trackingEnabled_ && tracker.trackedRow_ >= 0 &&
+        (tracker.framesSinceFullScan_ < maxTrackedFrames || tracker.trackingOnly_))
+    {
+        int band = std::max(trackBandMin, static_cast<int>(cropHeight * trackBandRatio));
+        scan = scanLevelBand(croppedImage, tracker.trackedRow_ - band, tracker.trackedRow_ + band, trackIterations,
+                             false);
+        tracked = scan.percentage >= 0 && scan.confidence >= minTrackConfidence;
+        if (!tracked)
         {
-            // 低通滤波缓慢下降
-            filtered_percentage = alpha * raw_percentage + (1 - alpha) * filtered_percentage;
+            tracker.trackLosses_++;
+            // 仅跟踪模式下跳过该帧，保留跟踪位置等待下一帧
+            if (tracker.trackingOnly_ && ++tracker.consecutiveLosses_ <= maxSkippedLosses)
+            {
+                tracker.skippedFrames_++;
+                return -1.0;
+            }
+            InfusionLogger::debug("液位线跟丢，置信度 {:.2f}，退回全图扫描", scan.confidence);
         }
     }
-    last_percentage = filtered_percentage;
-    final_result = filtered_percentage;
+    if (!tracked)
+    {
+        scan = scanLevelBand(croppedImage, 0, cropHeight, fullScanIterations, true);
+    }
+
+    int64_t scanNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - scanStart)
+                         .count();
+    if (tracked)
+    {
+        tracker.consecutiveLosses_ = 0;
+        tracker.trackedFrames_++;
+        tracker.trackedLatencyNs_ += scanNs;
+        tracker.framesSinceFullScan_++;
+    }
+    else
+    {
+        tracker.fullScans_++;
+        tracker.fullScanLatencyNs_ += scanNs;
+        tracker.framesSinceFullScan_ = 0;
+    }
+
+    if (scan.percentage < 0)
+    {
+        tracker.reset();
+        InfusionLogger::debug("未检测到有效液位线。");
+        return -1.0;
+    }
 
-    // 保存检测图片（最后一次）
-    Mat outputImage = croppedImage.clone();
+    // 只有可信的结果才作为下一帧的跟踪起点
+    if (tracked || scan.confidence >= minTrackConfidence)
+    {
+        tracker.trackedRow_ = static_cast<int>(scan.percentage / 100.0 * cropHeight);
+    }
+    else
+    {
+        tracker.trackedRow_ = -1;
+    }
+    double final_result = scan.percentage;
+
+    InfusionLogger::debug("液位占比: " + to_string(final_result) + "%");
+
+    if (!annotatedImage)
+    {
+        return std::clamp(final_result, 0.0, 100.0);
+    }
+
+    // 生成检测结果图片（最后一次），由调用方决定何时写盘
+    Mat &outputImage = *annotatedImage;
+    outputImage = croppedImage.clone();
     // 需要对croppedImage进行灰度和边缘处理，才能传给detectLiquidLevelLine
     Mat gray, edges;
     cvtColor(outputImage, gray, COLOR_BGR2GRAY);
@@ -238,9 +416,6 @@ double detectLiquidLevelPercentage(const Mat &inputImage, double totalVolume)
     }
     putText(outputImage, "Percentage: " + to_string(final_result) + "%", Point(10, 30), FONT_HERSHEY_SIMPLEX, 0.5,
             Scalar(255, 255, 255), 2);
-    imwrite("output.jpg", outputImage);
-
-    InfusionLogger::debug("最终液位占比: " + to_string(final_result) + "%");
 
     return std::clamp(final_result, 0.0, 100.0);
 }
@@ -0,0 +1,116 @@
+#include "load_shedder.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <bitset>
+
+LoadShedder::LoadShedder(std::chrono::milliseconds budget)
+    : budgetNs_(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count()),
+      stepUpFrames_(baseStepUpFrames_)
+{
+}
+
+void LoadShedder::setBudget(std::chrono::milliseconds budget)
+{
+    budgetNs_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count());
+    InfusionLogger::info("视觉处理单帧预算设置为 {} ms", budget.count());
+}
+
+std::chrono::milliseconds LoadShedder::getBudget() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(budgetNs_.load()));
+}
+
+bool LoadShedder::recordFrame(std::chrono::steady_clock::duration cost)
+{
+    int64_t costNs = std::chrono::duration_cast<std::chrono::nanoseconds>(cost).count();
+    int64_t budgetNs = budgetNs_.load();
+    if (budgetNs <= 0)
+    {
+        return false;
+    }
+
+    bool over = costNs > budgetNs;
+    recentOver_ = ((recentOver_ << 1) | (over ? 1u : 0u)) & ((1u << windowFrames_) - 1);
+    underBudget_ = costNs < budgetNs * headroom_ ? underBudget_ + 1 : 0;
+    framesSinceChange_++;
+
+    int mode = mode_.load();
+    if (std::bitset<32>(recentOver_).count() >= static_cast<size_t>(stepDownOverFrames_) && mode < MODE_COUNT - 1)
+    {
+        // 刚升级就再次超预算，说明余量不足，加倍下一次升级的等待
+        if (framesSinceChange_ <= stepUpFrames_)
+        {
+            stepUpFrames_ = std::min(stepUpFrames_ * 2, maxStepUpFrames_);
+        }
+        setMode(mode + 1);
+        return true;
+    }
+    if (underBudget_ >= stepUpFrames_ && mode > FULL)
+    {
+        setMode(mode - 1);
+        return true;
+    }
+    if (mode == FULL && framesSinceChange_ > maxStepUpFrames_)
+    {
+        // 长时间稳定后恢复升级等待
+        stepUpFrames_ = baseStepUpFrames_;
+    }
+    return false;
+}
+
+void LoadShedder::recordShed(uint64_t frames)
+{
+    shedFrames_ += frames;
+}
+
+LoadShedder::Mode LoadShedder::getMode() const
+{
+    return static_cast<Mode>(mode_.load());
+}
+
+uint64_t LoadShedder::getShedFrames() const
+{
+    return shedFrames_.load();
+}
+
+void LoadShedder::reset()
+{
+    mode_ = FULL;
+    recentOver_ = 0;
+    underBudget_ = 0;
+    framesSinceChange_ = 0;
+    stepUpFrames_ = baseStepUpFrames_;
+}
+
+const char *LoadShedder::modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case FULL:
+        return "full";
+    case REDUCED_RESOLUTION:
+        return "reduced_resolution";
+    case TRACKING_ONLY:
+        return "tracking_only";
+    case REDUCED_FPS:
+        return "reduced_fps";
+    default:
+        return "unknown";
+    }
+}
+
+void LoadShedder::setMode(int mode)
+{
+    int previous = mode_.exchange(mode);
+    recentOver_ = 0;
+    underBudget_ = 0;
+    framesSinceChange_ = 0;
+    if (mode > previous)
+    {
+        InfusionLogger::warn("视觉处理超出预算，降级为 {}", modeName(static_cast<Mode>(mode)));
+    }
+    else
+    {
+        InfusionLogger::info("视觉处理恢复为 {}", modeName(static_cast<Mode>(mode)));
+    }
+}
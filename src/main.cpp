@@ -4,6 +4,10 @@
 #include <fstream>
 #include <string>
 #include <unordered_map>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 
 // 显示帮助信息
 void showHelp(const char *programName)
@@ -16,6 +20,20 @@ void showHelp(const char *programName)
     std::cout << "  --file-only         只输出日志到文件" << std::endl;
     std::cout << "  --pump-data=FILE    指定泵数据文件路径 (默认: pump_data.json)" << std::endl;
     std::cout << "  --pump-name=NAME    指定泵名称 (默认: auto-infusion-01)" << std::endl;
+    std::cout << "  --camera-interval=MS 液位采样间隔毫秒 (默认: 100，>=2000 时相机按占空比取流)" << std::endl;
+    std::cout << "  --vision-budget=MS  液位检测单帧耗时预算毫秒，超出时逐级降级 (默认: 50)" << std::endl;
+    std::cout << "  --camera-calib=FILE 相机安装标定文件（镜头内参/畸变及可选瓶体平面单应矩阵）" << std::endl;
+    std::cout << "  --detector=NAME     液位检测策略 (hough, gradient, hsv, cnn[:模型路径]; 默认: hough)" << std::endl;
+    std::cout << "  --shadow-detector=NAME 影子检测策略，在后台抽样帧上运行并记录耗时与差异" << std::endl;
+    std::cout << "  --shadow-every=N    每N帧抽样一帧给影子检测 (默认: 10)" << std::endl;
+    std::cout << "  --open-loop         关闭基于液位实测流量的闭环转速修正" << std::endl;
+    std::cout << "  --motor-backend=NAME 电机后端 (gpiod: pwm_beeper脉冲, sysfs: 内核PWM脉冲, sim: 仿真; 默认: gpiod)" << std::endl;
+    std::cout << "  --pwm-chip=DIR      sysfs后端的PWM芯片目录 (默认: /sys/class/pwm/pwmchip0)" << std::endl;
+    std::cout << "  --pwm-channel=N     sysfs后端的PWM通道 (默认: 3，即GPIO19)" << std::endl;
+    std::cout << "  --pulsation-comp    按泵数据中的脉动剖面在每转内调制步频，平抑流量脉动（低速正转时生效）" << std::endl;
+    std::cout << "  --rt                电机控制线程以SCHED_FIFO运行并锁定内存（需要root或CAP_SYS_NICE）" << std::endl;
+    std::cout << "  --rt-priority=N     电机控制线程实时优先级 1-99 (默认: 80)" << std::endl;
+    std::cout << "  --rt-cpu=N          电机控制线程绑定的CPU编号 (默认: 不绑定)" << std::endl;
     std::cout << "  --help, -h          显示帮助信息" << std::endl;
 }
 
@@ -31,6 +49,26 @@ int main(int argc, char *argv[])
     std::string pumpDataFile = "pump_data.json";
     std::string pumpName = "auto-infusion-01";
 
+    // 相机配置默认值
+    int cameraIntervalMs = 100;
+    int visionBudgetMs = 50;
+    std::string cameraCalibFile;
+    std::string detectorName = "hough";
+    std::string shadowDetectorName;
+    int shadowEvery = 10;
+
+    // 流量闭环默认启用
+    bool flowTrim = true;
+
+    // 电机后端默认驱动实际硬件
+    std::string motorBackend = "gpiod";
+    std::string pwmChip = "/sys/class/pwm/pwmchip0";
+    int pwmChannel = 3;
+    bool pulsationComp = false;
+
+    // 电机控制线程实时配置，默认关闭
+    MotorDriver::RealtimeProfile realtimeProfile;
+
     // 解析命令行参数
     for (int i = 1; i < argc; ++i)
     {
@@ -95,6 +133,118 @@ int main(int argc, char *argv[])
         {
             pumpName = arg.substr(12); // 提取泵名称
         }
+        // 液位采样间隔选项
+        else if (arg.find("--camera-interval=") == 0)
+        {
+            cameraIntervalMs = std::atoi(arg.substr(18).c_str());
+            if (cameraIntervalMs <= 0)
+            {
+                std::cerr << "无效的采样间隔: " << arg.substr(18) << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
+        // 检测耗时预算选项
+        else if (arg.find("--vision-budget=") == 0)
+        {
+            visionBudgetMs = std::atoi(arg.substr(16).c_str());
+            if (visionBudgetMs <= 0)
+            {
+                std::cerr << "无效的检测耗时预算: " << arg.substr(16) << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
+        // 相机标定选项
+        else if (arg.find("--camera-calib=") == 0)
+        {
+            cameraCalibFile = arg.substr(15);
+        }
+        // 检测策略选项
+        else if (arg.find("--detector=") == 0)
+        {
+            detectorName = arg.substr(11);
+        }
+        else if (arg.find("--shadow-detector=") == 0)
+        {
+            shadowDetectorName = arg.substr(18);
+        }
+        else if (arg.find("--shadow-every=") == 0)
+        {
+            shadowEvery = std::atoi(arg.substr(15).c_str());
+            if (shadowEvery <= 0)
+            {
+                std::cerr << "无效的抽样间隔: " << arg.substr(15) << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
+        // 流量闭环选项
+        else if (arg == "--open-loop")
+        {
+            flowTrim = false;
+        }
+        // 电机后端选项
+        else if (arg.find("--motor-backend=") == 0)
+        {
+            motorBackend = arg.substr(16);
+            if (motorBackend != "gpiod" && motorBackend != "sysfs" && motorBackend != "sim")
+            {
+                std::cerr << "无效的电机后端: " << motorBackend << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.find("--pwm-chip=") == 0)
+        {
+            pwmChip = arg.substr(11);
+        }
+        else if (arg.find("--pwm-channel=") == 0)
+        {
+            // 须整体为非负十进制整数，拒绝 "3x"、"abc"、" 3" 等atoi会部分接受的写法
+            std::string value = arg.substr(14);
+            char *end = nullptr;
+            errno = 0;
+            long channel = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])) || *end != '\0' ||
+                errno == ERANGE || channel > INT_MAX)
+            {
+                std::cerr << "无效的PWM通道: " << value << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+            pwmChannel = static_cast<int>(channel);
+        }
+        else if (arg == "--pulsation-comp")
+        {
+            pulsationComp = true;
+        }
+        // 实时调度选项
+        else if (arg == "--rt")
+        {
+            realtimeProfile.enabled = true;
+        }
+        else if (arg.find("--rt-priority=") == 0)
+        {
+            realtimeProfile.priority = std::atoi(arg.substr(14).c_str());
+            if (realtimeProfile.priority < 1 || realtimeProfile.priority > 99)
+            {
+                std::cerr << "无效的实时优先级: " << arg.substr(14) << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.find("--rt-cpu=") == 0)
+        {
+            std::string value = arg.substr(9);
+            realtimeProfile.cpu = std::atoi(value.c_str());
+            if (value.empty() || realtimeProfile.cpu < 0)
+            {
+                std::cerr << "无效的CPU编号: " << value << std::endl;
+                showHelp(argv[0]);
+                return 1;
+            }
+        }
         // 未知选项
         else
         {
@@ -116,6 +266,15 @@ int main(int argc, char *argv[])
     {
         // 创建并初始化应用程序
         InfusionApp app(pumpDataFile, pumpName);
+        app.setCameraSampleInterval(cameraIntervalMs);
+        app.setVisionBudget(visionBudgetMs);
+        app.setDetectorStrategy(detectorName, shadowDetectorName, shadowEvery);
+        app.setCameraCalibration(cameraCalibFile);
+        app.setFlowTrim(flowTrim);
+        app.setRealtimeProfile(realtimeProfile);
+        app.setMotorBackend(motorBackend);
+        app.setPwmChannel(pwmChip, pwmChannel);
+        app.setPulsationCompensation(pulsationComp);
 
         if (!app.initialize())
         {
@@ -0,0 +1,133 @@
+#include "motion_planner.hpp"
+#include <algorithm>
+#include <cmath>
+
+MotionPlanner::MotionPlanner(double tick)
+    : tick_(tick > 0 ? tick : 0.01)
+{
+    // 归一化速度曲线 s(u)，u∈[0,1]，s(0)=0，s(1)=1；表中存位置积分 P(u)=∫s，P(1)=0.5
+    for (int i = 0; i <= tableSize_; i++)
+    {
+        double u = static_cast<double>(i) / tableSize_;
+        positionTable_[TRAPEZOIDAL][i] = u * u / 2.0;
+        positionTable_[S_CURVE][i] = u < 0.5 ? 2.0 * u * u * u / 3.0
+                                             : u - 0.5 + 2.0 * std::pow(1.0 - u, 3) / 3.0;
+    }
+}
+
+double MotionPlanner::position(Profile profile, double u) const
+{
+    if (u <= 0.0)
+        return 0.0;
+    if (u >= 1.0)
+        return positionTable_[profile][tableSize_];
+
+    double x = u * tableSize_;
+    int i = static_cast<int>(x);
+    double frac = x - i;
+    const auto &table = positionTable_[profile];
+    return table[i] + frac * (table[i + 1] - table[i]);
+}
+
+double MotionPlanner::rampTime(double delta, double accel, Profile profile)
+{
+    // S形曲线的峰值加速度是平均加速度的2倍，限制峰值时时长加倍
+    double t = std::abs(delta) / accel;
+    return profile == S_CURVE ? 2.0 * t : t;
+}
+
+void MotionPlanner::appendRamp(Plan &plan, double from, double to, double accel, Profile profile,
+                               bool round) const
+{
+    double total = rampTime(to - from, accel, profile);
+    int n = std::max(1, static_cast<int>(std::ceil(total / tick_ - 1e-9)));
+    double dt = total / n;
+    for (int i = 0; i < n; i++)
+    {
+        // 每点取该区间内的平均速率，使步数积分与连续曲线一致
+        double u0 = static_cast<double>(i) / n;
+        double u1 = static_cast<double>(i + 1) / n;
+        double rate = from + (to - from) * (position(profile, u1) - position(profile, u0)) / (u1 - u0);
+        if (round)
+        {
+            rate = std::round(rate);
+            if (rate <= 0.0)
+                continue; // 取整为0的点不产生步数，直接略去
+        }
+        plan.points.push_back({rate, dt});
+        plan.steps += rate * dt;
+        plan.duration += dt;
+    }
+}
+
+void MotionPlanner::Plan::clear()
+{
+    points.clear();
+    steps = 0.0;
+    duration = 0.0;
+}
+
+void MotionPlanner::planRamp(double from, double to, double accel, Profile profile, Plan &plan) const
+{
+    plan.clear();
+    if (from == to || accel <= 0)
+    {
+        if (from != to)
+            plan.points.push_back({to, 0.0});
+        return;
+    }
+
+    appendRamp(plan, from, to, accel, profile, false);
+    plan.points.push_back({to, 0.0});
+}
+
+void MotionPlanner::planMove(int steps, double maxRate, double accel, Profile profile, Plan &plan) const
+{
+    plan.clear();
+    if (steps <= 0 || maxRate <= 0 || accel <= 0)
+        return;
+
+    // 加减速各占 V²/2a（梯形）或 V²/a（S形）步，步数不够时降低匀速步频
+    double rampFactor = profile == S_CURVE ? 1.0 : 0.5;
+    double rate = std::min(maxRate, std::sqrt(steps * accel / (2.0 * rampFactor)));
+    rate = std::max(1.0, std::floor(rate));
+
+    while (true)
+    {
+        plan.clear();
+        appendRamp(plan, 0.0, rate, accel, profile, true);
+        double cruise = (steps - 2.0 * plan.steps) / rate;
+        if (cruise < 0.0 && rate > 1.0)
+        {
+            rate = std::max(1.0, rate - 1.0);
+            continue;
+        }
+
+        if (cruise < 0.0)
+        {
+            // 1Hz仍放不下加减速段：直接以1Hz运行
+            plan.clear();
+            cruise = steps;
+        }
+
+        size_t rampPoints = plan.points.size();
+        double rampSteps = plan.steps;
+        double rampDuration = plan.duration;
+        if (cruise > 0.0)
+        {
+            plan.points.push_back({rate, cruise});
+            plan.steps += rate * cruise;
+            plan.duration += cruise;
+        }
+        // 减速段与加速段对称
+        for (size_t i = rampPoints; i-- > 0;)
+        {
+            Point point = plan.points[i];
+            plan.points.push_back(point);
+        }
+        plan.steps += rampSteps;
+        plan.duration += rampDuration;
+        plan.points.push_back({0.0, 0.0});
+        return;
+    }
+}
@@ -1,38 +1,41 @@
 #include "motor_driver.hpp"
 #include "logger.hpp"
+#include "motor_hal/motor_gpiod.hpp"
 #include <iostream>
-#include <fcntl.h>
-#include <unistd.h>
+#include <cerrno>
 #include <cstring>
-#include <linux/input.h>
 #include <thread>
 #include <chrono>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <cmath>
 
 MotorDriver::MotorDriver(const char *chipname, int dirPin, const int microPins[3], const char *motorPwmDevice,
                          PumpState &pumpState)
-    : chipname_(chipname), dirPin_(dirPin), motorPwmDevice_(motorPwmDevice), pumpState_(pumpState)
+    : MotorDriver(std::make_shared<MotorHAL::MotorBackend_Gpiod>(chipname, dirPin, microPins, motorPwmDevice),
+                  pumpState)
 {
-    // 复制细分控制引脚数组
-    for (int i = 0; i < 3; i++)
-    {
-        microPins_[i] = microPins[i];
-    }
+}
+
+MotorDriver::MotorDriver(std::shared_ptr<MotorHAL::MotorBackend> backend, PumpState &pumpState)
+    : backend_(std::move(backend)), pumpState_(pumpState)
+{
+    // 规划缓冲一次性预留，控制线程中不再扩容
+    plan_.points.reserve(planCapacity_);
+    for (size_t i = 0; i < logRingSize_; i++)
+        logRing_[i].sequence.store(i, std::memory_order_relaxed);
 }
 
 MotorDriver::~MotorDriver()
 {
     stopControlThread();
 
-    // 关闭PWM设备
-    if (motor_fd_ >= 0)
+    // 释放电机硬件
+    if (backend_)
     {
-        close(motor_fd_);
-    }
-
-    // 释放GPIO资源
-    if (chip_)
-    {
-        gpiod_chip_close(chip_);
+        backend_->close();
     }
 }
 
@@ -40,51 +43,18 @@ bool MotorDriver::initialize()
 {
     try
     {
-        // 打开GPIO芯片
-        chip_ = gpiod_chip_open_by_name(chipname_);
-        if (!chip_)
-        {
-            InfusionLogger::error("打开GPIO芯片失败");
-            return false;
-        }
-
-        // 获取方向控制引脚
-        dirLine_ = gpiod_chip_get_line(chip_, dirPin_);
-        if (!dirLine_)
+        if (!backend_ || !backend_->open())
         {
-            InfusionLogger::error("获取方向GPIO失败");
+            InfusionLogger::error("打开电机后端失败");
             return false;
         }
+        InfusionLogger::info("电机后端: {}", backend_->name());
 
-        if (gpiod_line_request_output(dirLine_, "MotorDriver", 0) < 0)
+        // 后端打开后方向与细分编码为0、频率为0
         {
-            InfusionLogger::error("请求方向GPIO输出模式失败");
-            return false;
-        }
-
-        // 获取细分控制引脚
-        for (int i = 0; i < 3; i++)
-        {
-            microLines_[i] = gpiod_chip_get_line(chip_, microPins_[i]);
-            if (!microLines_[i])
-            {
-                InfusionLogger::error("获取细分控制GPIO失败");
-                return false;
-            }
-
-            if (gpiod_line_request_output(microLines_[i], "MotorDriver", 0) < 0)
-            {
-                InfusionLogger::error("请求细分控制GPIO输出模式失败");
-                return false;
-            }
-        }
-
-        // 开启PWM
-        motor_fd_ = open(motorPwmDevice_, O_RDWR);
-        if (motor_fd_ < 0)
-        {
-            InfusionLogger::error("打开电机PWM设备失败");
-            return false;
+            std::lock_guard<std::mutex> lock(hwMutex_);
+            appliedDirection_ = 0;
+            appliedMicrostepBits_ = 0;
         }
 
         // 初始设置
@@ -108,26 +78,22 @@ void MotorDriver::setDirection(int direction)
         return;
     }
 
-    if (dirLine_ == nullptr)
+    if (!backend_->isOpened)
     {
-        InfusionLogger::error("方向GPIO未初始化");
+        InfusionLogger::error("电机后端未初始化");
         return;
     }
 
     currentDirection_ = direction;
 
-    // 设置方向
-    if (gpiod_line_set_value(dirLine_, direction) < 0)
+    // 设置方向，细分保持不变
+    if (applyOutputs(direction, -1))
     {
-        InfusionLogger::error("设置方向GPIO失败");
-    }
-    else
-    {
-        InfusionLogger::debug("电机方向已设置为: {}", direction);
+        logEvent(LOG_DIRECTION_SET, direction);
     }
 }
 
-void MotorDriver::setMicrostep(int microstep)
+int MotorDriver::microstepBits(int microstep)
 {
     // 按照真值表转换
     // 000 -> 1
@@ -136,45 +102,284 @@ void MotorDriver::setMicrostep(int microstep)
     // 011 -> 8
     // 100 -> 16
     // 101 -> 32
-    int microstep_value = 0;
     switch (microstep)
     {
     case 1:
-        microstep_value = 0;
-        break;
+        return 0;
     case 2:
-        microstep_value = 1;
-        break;
+        return 1;
     case 4:
-        microstep_value = 2;
-        break;
+        return 2;
     case 8:
-        microstep_value = 3;
-        break;
+        return 3;
     case 16:
-        microstep_value = 4;
-        break;
+        return 4;
     case 32:
-        microstep_value = 5;
-        break;
+        return 5;
     default:
+        return -1;
+    }
+}
+
+void MotorDriver::setMicrostep(int microstep)
+{
+    int microstep_value = microstepBits(microstep);
+    if (microstep_value < 0)
+    {
         InfusionLogger::warn("microstep值范围必须在1 2 4 8 16 32之间，收到: {}", microstep);
         return;
     }
 
     currentMicrostep_ = microstep;
 
-    // 分别设置3个位的细分控制
-    for (int i = 0; i < 3; i++)
+    // 设置3个位的细分控制，方向保持不变
+    if (applyOutputs(-1, microstep_value))
+    {
+        logEvent(LOG_MICROSTEP_SET, microstep);
+    }
+}
+
+void MotorDriver::setOutputs(int direction, int microstep)
+{
+    currentDirection_ = direction;
+    currentMicrostep_ = microstep;
+
+    // 方向与细分在同一次批量写入中切换，驱动器不会看到中间组合
+    if (applyOutputs(direction, microstepBits(microstep)))
+    {
+        logEvent(LOG_OUTPUTS_SET, direction, microstep);
+    }
+}
+
+bool MotorDriver::applyOutputs(int direction, int bits)
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    // -1表示保持已下发的值
+    if (direction < 0)
+        direction = appliedDirection_ >= 0 ? appliedDirection_ : 0;
+    if (bits < 0)
+        bits = appliedMicrostepBits_ >= 0 ? appliedMicrostepBits_ : 0;
+
+    if (direction == appliedDirection_ && bits == appliedMicrostepBits_)
+    {
+        // 新命令与硬件一致，之前失败的值不再需要重试
+        pendingDirection_ = -1;
+        pendingMicrostepBits_ = -1;
+        commandsSuppressed_++;
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    settleOdometer(now);
+    syscalls_++;
+    if (!backend_->writeOutputs(direction, bits))
+    {
+        // 写入失败时硬件保持原值，里程计继续按原值计数，由控制线程重试
+        pendingDirection_ = direction;
+        pendingMicrostepBits_ = bits;
+        commandsFailed_++;
+        if (!outputsFailing_)
+            logEvent(LOG_OUTPUTS_WRITE_FAILED, direction, bits, backend_->lastError);
+        outputsFailing_ = true;
+        return false;
+    }
+    if (outputsFailing_)
+        logEvent(LOG_OUTPUTS_WRITE_RECOVERED);
+    outputsFailing_ = false;
+    pendingDirection_ = -1;
+    pendingMicrostepBits_ = -1;
+    appliedDirection_ = direction;
+    appliedMicrostepBits_ = bits;
+    startSegment(now);
+    commandsApplied_++;
+    return true;
+}
+
+bool MotorDriver::applyFrequency(double frequency)
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    dithering_ = false;
+    modulating_ = false;
+    return applyFrequencyLocked(frequency);
+}
+
+bool MotorDriver::applyFrequencyLocked(double frequency)
+{
+    if (frequency == appliedFrequency_)
+    {
+        pendingFrequency_ = -1;
+        commandsSuppressed_++;
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    settleOdometer(now);
+    syscalls_++;
+    if (!backend_->writeFrequency(frequency))
+    {
+        // 同上，电机仍以原频率运行
+        pendingFrequency_ = frequency;
+        commandsFailed_++;
+        if (!frequencyFailing_)
+            logEvent(LOG_FREQUENCY_WRITE_FAILED, frequency, backend_->lastError);
+        frequencyFailing_ = true;
+        return false;
+    }
+    if (frequencyFailing_)
+        logEvent(LOG_FREQUENCY_WRITE_RECOVERED);
+    frequencyFailing_ = false;
+    pendingFrequency_ = -1;
+    appliedFrequency_ = frequency;
+    startSegment(now);
+    commandsApplied_++;
+    return true;
+}
+
+bool MotorDriver::retryFailedWrites()
+{
+    int direction, bits;
+    {
+        std::lock_guard<std::mutex> lock(hwMutex_);
+        direction = pendingDirection_;
+        bits = pendingMicrostepBits_;
+    }
+    if (direction >= 0)
+        applyOutputs(direction, bits);
+
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    // 频率重试不打断小数频率抖动
+    if (pendingFrequency_ >= 0)
+        applyFrequencyLocked(pendingFrequency_);
+    return pendingDirection_ >= 0 || pendingFrequency_ >= 0;
+}
+
+void MotorDriver::settleOdometer(std::chrono::steady_clock::time_point now)
+{
+    double revolutions = segmentRevPerSec_ * std::chrono::duration<double>(now - segmentStart_).count();
+    odometer_.revolutions += revolutions;
+    odometer_.volume += revolutions * segmentMlPerRev_;
+    rotorPosition_ = std::fmod(rotorPosition_ + revolutions, 1.0);
+    if (rotorPosition_ < 0)
+        rotorPosition_ += 1.0;
+    segmentStart_ = now;
+}
+
+void MotorDriver::startSegment(std::chrono::steady_clock::time_point now)
+{
+    segmentStart_ = now;
+    segmentRevPerSec_ = 0.0;
+    segmentMlPerRev_ = 0.0;
+    // 频率、方向或细分未知时不计数
+    if (appliedFrequency_ <= 0 || appliedDirection_ < 0 || appliedMicrostepBits_ < 0)
+        return;
+
+    int microstep = 1 << appliedMicrostepBits_;
+    double revPerSec = appliedFrequency_ / (stepsPerRevolution_ * microstep);
+    segmentRevPerSec_ = appliedDirection_ == 1 ? revPerSec : -revPerSec;
+
+    if (appliedFrequency_ >= 1.0 && appliedFrequency_ < flowTableSize_ - 1 && !mlPerRevTable_.empty())
+    {
+        // 非整数频率在相邻两项间线性插值
+        int index = static_cast<int>(appliedFrequency_);
+        double frac = appliedFrequency_ - index;
+        const double *row = &mlPerRevTable_[appliedMicrostepBits_ * flowTableSize_];
+        segmentMlPerRev_ = row[index] + frac * (row[index + 1] - row[index]);
+    }
+    else if (flowModel_)
+    {
+        // 超出表范围（非常规转速）时直接计算
+        double rpm = revPerSec * 60.0;
+        double flow = flowModel_(rpm);
+        if (flow > 0)
+            segmentMlPerRev_ = flow / (60.0 * rpm);
+    }
+}
+
+void MotorDriver::setFlowModel(std::function<double(double)> flowModel)
+{
     {
-        int bit = (microstep_value >> i) & 0x1;
-        if (gpiod_line_set_value(microLines_[i], bit) < 0)
+        std::lock_guard<std::mutex> lock(hwMutex_);
+        flowModel_ = std::move(flowModel);
+    }
+    buildFlowTable();
+}
+
+void MotorDriver::refreshFlowModel()
+{
+    buildFlowTable();
+}
+
+void MotorDriver::buildFlowTable()
+{
+    std::function<double(double)> model;
+    {
+        std::lock_guard<std::mutex> lock(hwMutex_);
+        model = flowModel_;
+    }
+
+    // 在调用线程中求值（流量模型可能分配内存），控制线程只查表
+    std::vector<double> table;
+    if (model)
+    {
+        table.assign(6 * flowTableSize_, 0.0);
+        for (int bits = 0; bits < 6; bits++)
         {
-            InfusionLogger::error("设置细分控制GPIO失败");
+            for (int frequency = 1; frequency < flowTableSize_; frequency++)
+            {
+                double rpm = frequency * 60.0 / (stepsPerRevolution_ * (1 << bits));
+                double flow = model(rpm);
+                if (flow > 0)
+                    table[bits * flowTableSize_ + frequency] = flow / (60.0 * rpm);
+            }
         }
     }
 
-    InfusionLogger::debug("电机细分已设置为: {}", microstep);
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    auto now = std::chrono::steady_clock::now();
+    settleOdometer(now);
+    mlPerRevTable_.swap(table);
+    startSegment(now);
+}
+
+MotorDriver::Odometer MotorDriver::getOdometer() const
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    double revolutions = segmentRevPerSec_ *
+                         std::chrono::duration<double>(std::chrono::steady_clock::now() - segmentStart_).count();
+    Odometer odometer = odometer_;
+    odometer.revolutions += revolutions;
+    odometer.volume += revolutions * segmentMlPerRev_;
+    return odometer;
+}
+
+void MotorDriver::resetOdometer()
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    odometer_ = Odometer();
+    segmentStart_ = std::chrono::steady_clock::now();
+}
+
+double MotorDriver::timeToVolume(double target) const
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - segmentStart_).count();
+    double rate = segmentRevPerSec_ * segmentMlPerRev_; // ml/s
+    double remaining = target - (odometer_.volume + rate * elapsed);
+    if (remaining <= 0)
+        return 0.0;
+    if (rate <= 0)
+        return -1.0;
+    return remaining / rate;
+}
+
+MotorDriver::CommandStats MotorDriver::getCommandStats() const
+{
+    CommandStats stats;
+    stats.applied = commandsApplied_.load();
+    stats.suppressed = commandsSuppressed_.load();
+    stats.syscalls = syscalls_.load();
+    stats.failed = commandsFailed_.load();
+    return stats;
 }
 
 int MotorDriver::getDirection() const
@@ -193,54 +398,202 @@ void MotorDriver::setSpeed(double speed)
     current_speed_ = speed;
 
     // 速度最大值： 150rpm
-    // 最小：0.009375rpm
-    // 频率最高不超过500
-    if (abs(speed) <= 0.009375)
-    {
-        // 停止电机
-        struct input_event stop_event;
-        memset(&stop_event, 0, sizeof(stop_event));
-        stop_event.type = EV_SND;
-        stop_event.code = SND_TONE;
-        stop_event.value = 0;
-        write(motor_fd_, &stop_event, sizeof(stop_event));
-        InfusionLogger::debug("电机已停止");
+    // 最小：0.009375rpm（32细分下1Hz）
+    if (std::abs(speed) <= 0.009375)
+    {
+        // 停止电机，重新起步时重新选档
+        rateBand_ = -1;
+        if (applyFrequency(0))
+        {
+            logEvent(LOG_SPEED_STOPPED);
+        }
         return;
     }
 
-    double frequency = 0;
+    // 按转速选择细分档位，档位边界附近带回差
+    int band = StepRateTable::select(std::abs(speed), rateBand_.load());
+    rateBand_ = band;
+    const StepRateTable::Band &rate = StepRateTable::bands[band];
+    double frequency = std::abs(speed) * rate.hzPerRpm;
 
-    // 根据speed的rpm决定细分值
-    static int microstep[] = {32, 16, 8, 4, 2, 1};
+    setOutputs(speed > 0 ? 1 : 0, rate.microstep);
 
-    int i = 0;
-    for (; i < sizeof(microstep) / sizeof(microstep[0]); i++)
+    bool applied;
     {
-        frequency = abs(speed) * 6 * microstep[i] / 1.8;
-        if (frequency < 500 / microstep[i])
+        std::lock_guard<std::mutex> lock(hwMutex_);
+        double revPerSec = std::abs(speed) / 60.0;
+        if (pulsationEnabled_ && pulsationProfileValid_ && speed > 0 &&
+            revPerSec * pulsationSegments_ * pulsationMinSegment_ <= 1.0)
         {
-            setMicrostep(microstep[i]);
-            break;
+            // 脉动补偿：一转内按剖面逐段调制频率
+            if (modulating_ && frequency == modTarget_ && rate.microstep == modMicrostep_)
+                return; // 目标未变，保持当前调制节奏
+
+            dithering_ = false;
+            modulating_ = true;
+            modTarget_ = frequency;
+            modMicrostep_ = rate.microstep;
+            startModulation(std::chrono::steady_clock::now());
+            applied = true;
+        }
+        else if (backend_->fractionalFrequency())
+        {
+            // 后端可直接产生非整数频率，无需抖动
+            dithering_ = false;
+            modulating_ = false;
+            applied = applyFrequencyLocked(frequency);
+        }
+        else
+        {
+            // 只接受整数Hz：先下发最接近的整数，小数部分由控制线程抖动补足
+            modulating_ = false;
+            if (dithering_ && frequency == ditherTarget_)
+                return; // 目标未变，保持当前抖动节奏
+
+            ditherTarget_ = frequency;
+            ditherLow_ = static_cast<int>(std::floor(frequency));
+            ditherFraction_ = frequency - ditherLow_;
+            ditherHigh_ = ditherFraction_ >= 0.5;
+            dithering_ = ditherFraction_ > 1e-6 && ditherFraction_ < 1.0 - 1e-6;
+            double phase = ditherHigh_ ? ditherFraction_ : 1.0 - ditherFraction_;
+            ditherSwitchAt_ = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(ditherWindow_ * phase);
+            applied = applyFrequencyLocked(std::round(frequency));
         }
     }
+    if (applied)
+    {
+        logEvent(LOG_SPEED_SET, speed, rate.microstep, frequency);
+    }
+}
 
-    if (i == sizeof(microstep) / sizeof(microstep[0]))
+std::chrono::steady_clock::time_point MotorDriver::rateStep(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    if (modulating_)
     {
-        setMicrostep(microstep[i - 1]);
+        if (now >= modSwitchAt_)
+        {
+            if (now - modSwitchAt_ > std::chrono::seconds(1))
+            {
+                // 线程长时间阻塞，按当前转子位置重新对齐
+                startModulation(now);
+            }
+            else
+            {
+                modSegment_ = (modSegment_ + 1) % pulsationSegments_;
+                writeModulationSegment(1.0);
+            }
+        }
+        return modSwitchAt_;
     }
 
-    setDirection(speed > 0 ? 1 : 0);
+    if (!dithering_)
+        return std::chrono::steady_clock::time_point::max();
 
-    struct input_event beep_event;
+    if (now >= ditherSwitchAt_)
+    {
+        // 从计划切换时刻累加，唤醒延迟不影响平均频率；落后超过一个窗口（线程长时间阻塞）时重新对齐
+        if (now - ditherSwitchAt_ > ditherWindow_)
+            ditherSwitchAt_ = now;
+        ditherHigh_ = !ditherHigh_;
+        double phase = ditherHigh_ ? ditherFraction_ : 1.0 - ditherFraction_;
+        ditherSwitchAt_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(ditherWindow_ * phase);
+        applyFrequencyLocked(ditherHigh_ ? ditherLow_ + 1.0 : ditherLow_);
+    }
+    return ditherSwitchAt_;
+}
 
-    // 设置频率 (频率单位可能需要适应不同的硬件)
-    memset(&beep_event, 0, sizeof(beep_event));
-    beep_event.type = EV_SND;
-    beep_event.code = SND_TONE;
-    beep_event.value = int(frequency);
-    write(motor_fd_, &beep_event, sizeof(beep_event));
+void MotorDriver::startModulation(std::chrono::steady_clock::time_point now)
+{
+    double position = rotorPosition_ + segmentRevPerSec_ * std::chrono::duration<double>(now - segmentStart_).count() +
+                      pulsationPhase_;
+    position -= std::floor(position);
+    double x = position * pulsationSegments_;
+    modSegment_ = std::min(static_cast<int>(x), pulsationSegments_ - 1);
+    modCarry_ = 0.0;
+    modSwitchAt_ = now;
+    writeModulationSegment(1.0 - (x - modSegment_));
+}
 
-    InfusionLogger::debug("电机速度已设置为: {}rpm，频率: {}Hz", speed, frequency);
+void MotorDriver::writeModulationSegment(double fraction)
+{
+    // 本段微步数与按剖面应持续的时间；加上前面取整欠下的时间后反求频率
+    double steps = fraction * stepsPerRevolution_ * modMicrostep_ / pulsationSegments_;
+    double desired = steps / (modTarget_ * pulsationRate_[modSegment_]);
+    double target = desired + modCarry_;
+    if (target <= 0)
+        target = desired;
+    double frequency = steps / target;
+    if (!backend_->fractionalFrequency())
+        frequency = std::max(1.0, std::round(frequency));
+
+    double actual = steps / frequency;
+    modCarry_ = target - actual;
+    modSwitchAt_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(actual));
+    applyFrequencyLocked(frequency);
+}
+
+void MotorDriver::setPulsationProfile(const std::vector<double> &profile)
+{
+    std::array<double, pulsationSegments_> rate{};
+    bool valid = profile.size() >= 2;
+    for (double value : profile)
+        valid = valid && std::isfinite(value) && value > 0;
+
+    if (valid)
+    {
+        // 周期性线性插值后按段求平均排量，归一化为均值1；速率倍数取倒数，其按角度的调和平均为1
+        constexpr int subsamples = 16;
+        size_t n = profile.size();
+        double mean = 0.0;
+        for (int k = 0; k < pulsationSegments_; k++)
+        {
+            double sum = 0.0;
+            for (int j = 0; j < subsamples; j++)
+            {
+                double x = (k + (j + 0.5) / subsamples) / pulsationSegments_ * n;
+                size_t i0 = static_cast<size_t>(x) % n;
+                double frac = x - std::floor(x);
+                sum += profile[i0] + frac * (profile[(i0 + 1) % n] - profile[i0]);
+            }
+            rate[k] = sum / subsamples;
+            mean += rate[k] / pulsationSegments_;
+        }
+        for (auto &r : rate)
+            r = mean / r;
+    }
+    else if (!profile.empty())
+    {
+        InfusionLogger::warn("脉动补偿剖面无效（至少2个正数样本），已忽略");
+    }
+
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    pulsationRate_ = rate;
+    pulsationProfileValid_ = valid;
+    if (!valid)
+        modulating_ = false;
+}
+
+void MotorDriver::setPulsationCompensation(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    pulsationEnabled_ = enabled;
+    if (enabled && !pulsationProfileValid_)
+        InfusionLogger::warn("脉动补偿已启用，但泵没有有效的脉动剖面");
+}
+
+void MotorDriver::setPulsationPhase(double phase)
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    pulsationPhase_ = phase - std::floor(phase);
+}
+
+bool MotorDriver::isPulsationActive() const
+{
+    std::lock_guard<std::mutex> lock(hwMutex_);
+    return modulating_;
 }
 
 double MotorDriver::getSpeed() const
@@ -264,6 +617,7 @@ void MotorDriver::startControlThread(PumpParams &pumpParams, std::atomic<bool> &
 void MotorDriver::stopControlThread()
 {
     control_thread_running_ = false;
+    notify();
     // 给线程一些时间来完成当前操作
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
@@ -276,20 +630,308 @@ bool MotorDriver::isControlThreadRunning() const
     return control_thread_running_.load();
 }
 
+void MotorDriver::notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeSeq_++;
+    }
+    wakeCond_.notify_one();
+}
+
+void MotorDriver::setRampProfile(MotionPlanner::Profile profile)
+{
+    rampProfile_ = profile;
+}
+
+bool MotorDriver::isMoving() const
+{
+    return moving_.load();
+}
+
+bool MotorDriver::rampTo(double rpm, PumpControlState state)
+{
+    if (std::abs(rpm) <= 0.009375)
+    {
+        setSpeed(0);
+        return true;
+    }
+
+    planner_.planRamp(current_speed_, rpm, rampAccel_, rampProfile_, plan_);
+    return executePlan(plan_, state, [this](double rate)
+                       { setSpeed(rate); });
+}
+
+bool MotorDriver::moveSteps(int steps, int direction, int microstep, double rate, PumpControlState state)
+{
+    planner_.planMove(steps, rate, moveAccel_ * microstep, rampProfile_, plan_);
+    setOutputs(direction, microstep);
+    return executePlan(plan_, state, [this, microstep](double stepRate)
+                       {
+                           current_speed_ = stepRate * 1.8 / (6.0 * microstep);
+                           applyFrequency(std::round(stepRate)); });
+}
+
+bool MotorDriver::executePlan(const MotionPlanner::Plan &plan, PumpControlState state,
+                              const std::function<void(double)> &apply)
+{
+    moving_ = true;
+    bool completed = true;
+    auto deadline = std::chrono::steady_clock::now();
+    auto released = deadline;
+    for (const auto &point : plan.points)
+    {
+        apply(point.rate);
+        if (point.duration <= 0)
+            continue;
+
+        // 按绝对时刻等待，唤醒延迟不会在各点之间累积
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(point.duration));
+        if (waitUntil(deadline, [&]
+                      { return pumpState_.state.load() != state || !control_thread_running_; }))
+        {
+            completed = false;
+            break;
+        }
+
+        // 相邻两点实际间隔与计划间隔之差
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - released).count();
+        periodHistogram_.record(std::abs(interval - point.duration) * 1e6);
+        released = now;
+    }
+    moving_ = false;
+    return completed;
+}
+
+template <typename Stop>
+bool MotorDriver::waitUntil(std::chrono::steady_clock::time_point deadline, Stop stop)
+{
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    if (wakeCond_.wait_until(lock, deadline, stop))
+        return true;
+
+    latenessHistogram_.record(
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - deadline).count());
+    return false;
+}
+
+void MotorDriver::setRealtimeProfile(const RealtimeProfile &profile)
+{
+    if (control_thread_running_.load())
+    {
+        InfusionLogger::warn("电机控制线程运行中，实时配置需在启动前设置");
+        return;
+    }
+    realtimeProfile_ = profile;
+}
+
+// 预先触碰一段栈空间，配合mlockall使其常驻内存，循环中不再发生缺页
+static void __attribute__((noinline)) prefaultStack()
+{
+    volatile unsigned char stack[256 * 1024];
+    for (size_t i = 0; i < sizeof(stack); i += 4096)
+        stack[i] = 0;
+}
+
+void MotorDriver::applyRealtimeProfile()
+{
+    realtimeActive_ = false;
+    if (!realtimeProfile_.enabled)
+        return;
+
+    bool ok = true;
+    if (realtimeProfile_.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(realtimeProfile_.cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0)
+        {
+            InfusionLogger::warn("电机控制线程绑定CPU {} 失败: {}", realtimeProfile_.cpu, strerror(err));
+            ok = false;
+        }
+    }
+
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = realtimeProfile_.priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+    {
+        InfusionLogger::warn("电机控制线程设置SCHED_FIFO失败: {}（需要root或CAP_SYS_NICE）", strerror(err));
+        ok = false;
+    }
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        InfusionLogger::warn("锁定进程内存失败: {}", strerror(errno));
+        ok = false;
+    }
+    prefaultStack();
+
+    realtimeActive_ = ok;
+    InfusionLogger::info("电机控制线程实时配置{}: SCHED_FIFO 优先级 {}，CPU {}", ok ? "已生效" : "部分生效",
+                         realtimeProfile_.priority, realtimeProfile_.cpu);
+}
+
+MotorDriver::TimingStats MotorDriver::getTimingStats() const
+{
+    TimingStats stats;
+    stats.realtime = realtimeActive_.load();
+    stats.lateness = latenessHistogram_.snapshot();
+    stats.period = periodHistogram_.snapshot();
+    return stats;
+}
+
+void MotorDriver::logEvent(LogEventCode code, double a, double b, double c)
+{
+    LogEvent event{code, a, b, c};
+    if (!realtimeProfile_.enabled)
+    {
+        writeLog(event);
+        return;
+    }
+
+    // 按槽位序号认领位置：不加锁，生产者被抢占时只会推迟消费者，不会阻塞控制线程
+    size_t pos = logHead_.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    while (true)
+    {
+        slot = &logRing_[pos % logRingSize_];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence == pos)
+        {
+            if (logHead_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (sequence < pos)
+        {
+            // 队列已满
+            logDropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = logHead_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->event = event;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void MotorDriver::flushDeferredLogs()
+{
+    size_t tail = logTail_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        LogSlot &slot = logRing_[tail % logRingSize_];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+            break; // 空，或生产者尚未写完
+        LogEvent event = slot.event;
+        slot.sequence.store(tail + logRingSize_, std::memory_order_release);
+        tail++;
+        writeLog(event);
+    }
+    logTail_.store(tail, std::memory_order_relaxed);
+
+    uint64_t dropped = logDropped_.exchange(0);
+    if (dropped > 0)
+    {
+        InfusionLogger::warn("电机控制线程日志队列已满，丢弃 {} 条", dropped);
+    }
+}
+
+void MotorDriver::writeLog(const LogEvent &event)
+{
+    switch (event.code)
+    {
+    case LOG_DIRECTION_SET:
+        InfusionLogger::debug("电机方向已设置为: {}", static_cast<int>(event.a));
+        break;
+    case LOG_MICROSTEP_SET:
+        InfusionLogger::debug("电机细分已设置为: {}", static_cast<int>(event.a));
+        break;
+    case LOG_OUTPUTS_SET:
+        InfusionLogger::debug("电机方向已设置为: {}，细分已设置为: {}", static_cast<int>(event.a), static_cast<int>(event.b));
+        break;
+    case LOG_SPEED_SET:
+        InfusionLogger::debug("电机速度已设置为: {}rpm，细分: {}，频率: {}Hz", event.a, static_cast<int>(event.b), event.c);
+        break;
+    case LOG_SPEED_STOPPED:
+        InfusionLogger::debug("电机已停止");
+        break;
+    case LOG_OUTPUTS_WRITE_FAILED:
+        InfusionLogger::error("设置方向与细分失败: 方向 {}，细分编码 {} ({})，将重试",
+                              static_cast<int>(event.a), static_cast<int>(event.b), strerror(static_cast<int>(event.c)));
+        break;
+    case LOG_OUTPUTS_WRITE_RECOVERED:
+        InfusionLogger::info("方向与细分写入已恢复");
+        break;
+    case LOG_FREQUENCY_WRITE_FAILED:
+        InfusionLogger::error("写入步进脉冲频率失败: {} Hz ({})，将重试", event.a, strerror(static_cast<int>(event.b)));
+        break;
+    case LOG_FREQUENCY_WRITE_RECOVERED:
+        InfusionLogger::info("步进脉冲频率写入已恢复");
+        break;
+    case LOG_PARAMS_UPDATED:
+        InfusionLogger::info("电机参数已更新: 方向={}, 转速={} RPM", event.a > 0 ? "正向" : "反向", event.b);
+        break;
+    case LOG_CALIBRATION_RPM:
+        InfusionLogger::info("标定转速已更新: {} RPM", event.a);
+        break;
+    case LOG_RETRACT_START:
+        InfusionLogger::warn("紧急停止: 反向回抽 {} 步", static_cast<int>(event.a));
+        break;
+    case LOG_RETRACT_ABORTED:
+        InfusionLogger::warn("紧急停止: 回抽被状态变化中止");
+        break;
+    case LOG_MOTOR_STOPPED:
+        InfusionLogger::warn("紧急停止: 电机已停止");
+        break;
+    case LOG_VTBI_REACHED:
+        InfusionLogger::info("已达到待输注量 {:.2f} ml，电机停止", event.a);
+        break;
+    case LOG_UNKNOWN_STATE:
+        InfusionLogger::warn("未知的泵状态: {}", static_cast<int>(event.a));
+        break;
+    }
+}
+
 void MotorDriver::controlThread(PumpParams &pumpParams, std::atomic<bool> &paramsUpdatedFlag)
 {
     InfusionLogger::info("电机控制线程已启动");
+    applyRealtimeProfile();
 
-    // 用于紧急停止的时间控制
-    auto emergencyStopStartTime = std::chrono::steady_clock::now();
-    bool emergencyStopReverseDone = false;
+    // 紧急停止回抽只执行一次；记录上一轮状态以识别进入新状态
+    bool emergencyStopRetractDone = false;
+    PumpControlState lastState = ERROR;
 
     while (control_thread_running_)
     {
+        // 先记下通知序号再读取状态，处理期间到来的通知会让下面的等待立即返回
+        uint64_t seenSeq;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            seenSeq = wakeSeq_;
+        }
+        auto wakeAt = std::chrono::steady_clock::now() + housekeepingInterval_;
+
         try
         {
+            // 小数频率抖动或脉动补偿到切换时刻时先切换，后面的待输注量计算使用切换后的频率
+            rateStep(std::chrono::steady_clock::now());
+
             // 获取当前泵状态
             PumpControlState currentState = pumpState_.state.load();
+            bool entered = currentState != lastState;
+            lastState = currentState;
+            if (currentState != EMERGENCY_STOP)
+            {
+                emergencyStopRetractDone = false;
+            }
 
             // 根据不同状态控制电机行为
             switch (currentState)
@@ -307,22 +949,55 @@ void MotorDriver::controlThread(PumpParams &pumpParams, std::atomic<bool> &param
 
             case PREPARING:
                 // 准备状态，正向运行排空气
-                setDirection(true);              // 正向
-                setSpeed(pumpParams.target_rpm); // 使用目标转速
+                setDirection(true);                          // 正向
+                rampTo(pumpParams.target_rpm, currentState); // 按加速曲线到目标转速
                 break;
 
             case INFUSING:
+                // 已达到待输注量：保持停止，等待状态机结束输液
+                if (pumpState_.vtbi_reached.load())
+                {
+                    setSpeed(0);
+                    break;
+                }
+
                 // 输液状态，正向运行，使用参数中的方向和转速
-                if (paramsUpdatedFlag.exchange(false))
+                if (paramsUpdatedFlag.exchange(false) || entered)
                 {
                     // 更新电机方向
                     setDirection(pumpParams.direction);
-                    // 更新电机速度
-                    setSpeed(pumpParams.target_rpm);
+                    // 按加减速曲线更新电机速度
+                    rampTo(pumpParams.target_rpm, currentState);
 
-                    InfusionLogger::info("电机参数已更新: 方向={}, 转速={} RPM",
-                                         pumpParams.direction ? "正向" : "反向",
-                                         pumpParams.target_rpm.load());
+                    logEvent(LOG_PARAMS_UPDATED, pumpParams.direction ? 1.0 : 0.0, pumpParams.target_rpm.load());
+                }
+
+                // 待输注量：按当前频率算出到达时刻并在该时刻唤醒停止，精度不受维护周期限制
+                if (pumpParams.vtbi.load() > 0)
+                {
+                    double vtbi = pumpParams.vtbi.load();
+                    double seconds = timeToVolume(vtbi);
+                    if (seconds == 0.0)
+                    {
+                        setSpeed(0);
+                        pumpState_.vtbi_reached.store(true);
+                        logEvent(LOG_VTBI_REACHED, vtbi);
+                    }
+                    else if (seconds > 0)
+                    {
+                        wakeAt = std::min(wakeAt, std::chrono::steady_clock::now() +
+                                                      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                          std::chrono::duration<double>(seconds)));
+                    }
+                }
+                break;
+
+            case CALIBRATING:
+                // 标定状态，按标定程序逐级设置的转速正向运行
+                if (paramsUpdatedFlag.exchange(false) || entered)
+                {
+                    rampTo(pumpParams.target_rpm, currentState);
+                    logEvent(LOG_CALIBRATION_RPM, pumpParams.target_rpm.load());
                 }
                 break;
 
@@ -332,29 +1007,22 @@ void MotorDriver::controlThread(PumpParams &pumpParams, std::atomic<bool> &param
                 break;
 
             case EMERGENCY_STOP:
-                // 紧急停止状态，先反转一下，然后停止
-                if (!emergencyStopReverseDone)
+                // 紧急停止状态，先反向回抽固定步数，然后停止
+                if (!emergencyStopRetractDone)
                 {
-                    // 开始紧急停止时的反转
-                    setDirection(!pumpParams.direction);
-                    setSpeed(5.0); // 低速反转
-                    emergencyStopStartTime = std::chrono::steady_clock::now();
-                    emergencyStopReverseDone = true;
-                    InfusionLogger::warn("紧急停止: 开始反转");
+                    emergencyStopRetractDone = true;
+                    logEvent(LOG_RETRACT_START, retractSteps_);
+                    if (!moveSteps(retractSteps_, pumpParams.direction ? 0 : 1, retractMicrostep_, retractRate_,
+                                   currentState))
+                    {
+                        logEvent(LOG_RETRACT_ABORTED);
+                    }
+                    setSpeed(0);
+                    logEvent(LOG_MOTOR_STOPPED);
                 }
                 else
                 {
-                    // 检查是否反转时间已到
-                    auto now = std::chrono::steady_clock::now();
-                    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                         now - emergencyStopStartTime)
-                                         .count();
-
-                    if (elapsedMs >= 500)
-                    { // 反转0.5秒后停止
-                        setSpeed(0);
-                        InfusionLogger::warn("紧急停止: 电机已停止");
-                    }
+                    setSpeed(0);
                 }
                 break;
 
@@ -366,22 +1034,33 @@ void MotorDriver::controlThread(PumpParams &pumpParams, std::atomic<bool> &param
             default:
                 // 未知状态，安全起见不运行
                 setSpeed(0);
-                InfusionLogger::warn("未知的泵状态: {}", static_cast<int>(currentState));
+                logEvent(LOG_UNKNOWN_STATE, static_cast<int>(currentState));
                 break;
             }
 
+            // 写入失败的命令短周期重试，不等到下一次通知或维护周期
+            if (retryFailedWrites())
+            {
+                wakeAt = std::min(wakeAt, std::chrono::steady_clock::now() + writeRetryInterval_);
+            }
+
+            // 在下一个抖动或调制切换时刻唤醒
+            wakeAt = std::min(wakeAt, rateStep(std::chrono::steady_clock::now()));
+
             // 更新泵状态中的电机实际值
             pumpState_.current_speed.store(current_speed_);
             pumpState_.direction.store(currentDirection_ > 0);
-
-            // 控制周期
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            pumpState_.delivered_volume.store(getOdometer().volume);
         }
         catch (const std::exception &e)
         {
             InfusionLogger::error("电机控制线程出错: {}", e.what());
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            wakeAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
         }
+
+        // 等待状态/参数变化通知；无通知时按维护周期重新下发
+        waitUntil(wakeAt, [&]
+                  { return wakeSeq_ != seenSeq || !control_thread_running_; });
     }
 
     // 确保线程结束时电机停止
@@ -0,0 +1,425 @@
+// 电机驱动仿真：在仿真电机后端上运行真实的MotorDriver控制线程，统计VTBI剂量误差与故障注入下的表现，
+// 状态变化到硬件写入的延迟，以及步数运动的步数与时序精度
+#include "logger.hpp"
+#include "motion_planner.hpp"
+#include "motor_driver.hpp"
+#include "motor_hal/motor_sim.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using MotorHAL::MotorBackend_Sim;
+
+static void showHelp(const char *programName)
+{
+    cout << "用法: " << programName << " <场景>" << endl;
+    cout << "场景:" << endl;
+    cout << "  dose       10次0.30-0.66 ml的VTBI输注（30/60 RPM），分别在无故障、每7次写入失败1次、" << endl;
+    cout << "             0.5-2 ms写入延迟下统计剂量误差（整步）与里程计偏差" << endl;
+    cout << "  latency    在输液周期的随机时刻切换到IDLE或EMERGENCY_STOP，统计状态写入到停止/回抽命令写入的延迟，" << endl;
+    cout << "             区分控制线程空闲等待通知与加速中按截止时刻等待两种情况" << endl;
+    cout << "  timing     规划步数的精确性，以及100次紧急停止回抽的实际步数、总时长与各规划点的下发时刻误差" << endl;
+}
+
+static const size_t commandCapacity = 65536;
+static const double doseTolerance = 5.0; // 剂量与里程计误差容差（整步）
+static const double latencyMedianLimit = 5.0; // 状态变化到命令写入的延迟中位数上限 (ms)
+static const double latencyMaxLimit = 50.0;   // 延迟最大值上限 (ms)
+static const double retractStepTolerance = 2.0; // 回抽步数误差容差（微步）
+static const double releaseMedianLimit = 1.0;   // 规划点下发时刻误差中位数上限 (ms)
+
+// 一组故障配置下的剂量误差，单位为整步，以仿真后端积分的步数为准
+static bool doseRun(const string &label, const MotorBackend_Sim::Faults &faults, bool expectFailures)
+{
+    auto sim = make_shared<MotorBackend_Sim>(7, false, commandCapacity);
+    PumpState pumpState;
+    PumpParams pumpParams;
+    atomic<bool> paramsUpdated{false};
+    MotorDriver motor(sim, pumpState);
+    if (!motor.initialize())
+    {
+        cout << label << ": 初始化失败" << endl;
+        return false;
+    }
+    // 10 ml/h每RPM，即每转1/6 ml
+    motor.setFlowModel([](double rpm)
+                       { return 10.0 * rpm; });
+    motor.startControlThread(pumpParams, paramsUpdated);
+    sim->setFaults(faults);
+
+    vector<double> doseError;
+    vector<double> odometerError;
+    bool reached = true;
+    for (int i = 0; i < 10; ++i)
+    {
+        motor.setMotorState(IDLE);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        motor.resetOdometer();
+        sim->resetSteps();
+        pumpState.vtbi_reached = false;
+
+        double vtbi = 0.3 + 0.04 * i;
+        pumpParams.vtbi = vtbi;
+        pumpParams.target_rpm = (i % 2) ? 60.0 : 30.0;
+        paramsUpdated = true;
+        motor.setMotorState(INFUSING);
+        for (int wait = 0; !pumpState.vtbi_reached && wait < 6000; ++wait)
+        {
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+        reached = reached && pumpState.vtbi_reached;
+        // 等待停止命令（含失败重试）落地
+        this_thread::sleep_for(chrono::milliseconds(50));
+        doseError.push_back((sim->getRevolutions() - vtbi * 6.0) * 200.0);
+        odometerError.push_back((motor.getOdometer().revolutions - sim->getRevolutions()) * 200.0);
+    }
+    motor.setMotorState(IDLE);
+    motor.stopControlThread();
+
+    vector<MotorBackend_Sim::Command> commands = sim->getCommands();
+    size_t failed = count_if(commands.begin(), commands.end(), [](const MotorBackend_Sim::Command &command)
+                             { return command.failed; });
+    sort(doseError.begin(), doseError.end());
+    sort(odometerError.begin(), odometerError.end());
+    double worstDose = max(-doseError.front(), doseError.back());
+    double worstOdometer = max(-odometerError.front(), odometerError.back());
+    cout << fixed << setprecision(2) << label << ": 命令 " << commands.size() << " 失败 " << failed
+         << " | 剂量误差 最小 " << doseError.front() << " 中位 " << doseError[doseError.size() / 2] << " 最大 "
+         << doseError.back() << " | 里程计-仿真 最小 " << setprecision(3) << odometerError.front() << " 最大 "
+         << odometerError.back() << endl;
+
+    // 60 RPM下每整步5 ms，宿主机调度延迟可造成约1整步的误差；超过容差即视为剂量逻辑出错
+    // （写入失败时丢失停止命令的缺陷会造成数千步误差）
+    return reached && worstDose < doseTolerance && worstOdometer < doseTolerance && (failed > 0) == expectFailures &&
+           sim->getDroppedCommands() == 0;
+}
+
+static bool doseScenario()
+{
+    MotorBackend_Sim::Faults none;
+    MotorBackend_Sim::Faults failures;
+    failures.failEvery = 7;
+    MotorBackend_Sim::Faults delays;
+    delays.writeDelay = chrono::microseconds(500);
+    delays.writeJitter = chrono::microseconds(1500);
+
+    bool ok = doseRun("无故障", none, false);
+    ok = doseRun("每7次写入失败1次", failures, true) && ok;
+    ok = doseRun("0.5-2 ms写入延迟", delays, false) && ok;
+    return ok;
+}
+
+// 延迟样本的分位数，ms
+static double percentile(vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+static void printLatency(const string &label, const vector<double> &latencies)
+{
+    cout << fixed << setprecision(3) << label << ": " << latencies.size() << " 次 中位 " << percentile(latencies, 0.5)
+         << " ms p90 " << percentile(latencies, 0.9) << " ms p99 " << percentile(latencies, 0.99) << " ms 最大 "
+         << percentile(latencies, 1.0) << " ms" << endl;
+}
+
+// 以30 RPM输液随机一段时间后切换到target，返回状态写入到首条响应命令生效的延迟（ms），未找到为-1
+// IDLE的响应为频率0，EMERGENCY_STOP的响应为反向的方向输出；ramping返回切换时是否处于加速中
+static double transitionLatency(MotorDriver &motor, MotorBackend_Sim &sim, PumpParams &pumpParams,
+                                atomic<bool> &paramsUpdated, PumpControlState target, mt19937 &rng, bool &ramping)
+{
+    uniform_int_distribution<int> delay(20, 1200); // 加速到30 RPM的S形曲线约600 ms，约一半样本落在加速中
+
+    motor.setMotorState(IDLE);
+    for (int wait = 0; motor.isMoving() && wait < 400; ++wait)
+    {
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    this_thread::sleep_for(chrono::milliseconds(20));
+    sim.clearCommands();
+
+    pumpParams.direction = true;
+    pumpParams.target_rpm = 30.0;
+    paramsUpdated = true;
+    motor.setMotorState(INFUSING);
+    this_thread::sleep_for(chrono::milliseconds(delay(rng)));
+
+    ramping = motor.isMoving();
+    auto start = chrono::steady_clock::now();
+    motor.setMotorState(target);
+    this_thread::sleep_for(chrono::milliseconds(30));
+
+    for (const auto &command : sim.getCommands())
+    {
+        if (command.time < start || command.failed)
+            continue;
+        bool response = target == EMERGENCY_STOP
+                            ? command.type == MotorBackend_Sim::Command::OUTPUTS && command.direction == 0
+                            : command.type == MotorBackend_Sim::Command::FREQUENCY && command.frequency == 0.0;
+        if (response)
+            return chrono::duration<double, milli>(command.time - start).count();
+    }
+    return -1.0;
+}
+
+static bool latencyScenario()
+{
+    auto sim = make_shared<MotorBackend_Sim>(1, false, commandCapacity);
+    PumpState pumpState;
+    PumpParams pumpParams;
+    atomic<bool> paramsUpdated{false};
+    MotorDriver motor(sim, pumpState);
+    if (!motor.initialize())
+    {
+        cout << "初始化失败" << endl;
+        return false;
+    }
+    motor.startControlThread(pumpParams, paramsUpdated);
+
+    mt19937 rng(5);
+    bool ok = true;
+    for (PumpControlState target : {IDLE, EMERGENCY_STOP})
+    {
+        const int runs = target == IDLE ? 200 : 50;
+        vector<double> waiting;
+        vector<double> ramping;
+        int missing = 0;
+        for (int i = 0; i < runs; ++i)
+        {
+            bool inRamp = false;
+            double latency = transitionLatency(motor, *sim, pumpParams, paramsUpdated, target, rng, inRamp);
+            if (latency < 0)
+                missing++;
+            else
+                (inRamp ? ramping : waiting).push_back(latency);
+        }
+
+        string name = target == IDLE ? "INFUSING->IDLE" : "INFUSING->EMERGENCY_STOP";
+        printLatency(name + " 等待通知", waiting);
+        printLatency(name + " 加速中  ", ramping);
+        if (missing > 0)
+            cout << name << ": " << missing << " 次未找到响应命令" << endl;
+
+        // 改为通知驱动前按100 ms轮询，中位约50 ms、最大约100 ms
+        vector<double> all = waiting;
+        all.insert(all.end(), ramping.begin(), ramping.end());
+        ok = ok && missing == 0 && percentile(all, 0.5) < latencyMedianLimit && percentile(all, 1.0) < latencyMaxLimit;
+    }
+
+    motor.setMotorState(IDLE);
+    motor.stopControlThread();
+    return ok;
+}
+
+// 紧急停止回抽参数，与MotorDriver中一致：1/4细分下32微步，66 Hz，S形加减速
+static const int retractSteps = 32;
+static const int retractMicrostep = 4;
+static const double retractRate = 66.0;
+static const double retractAccel = 165.0 * retractMicrostep;
+
+// 规划的Σ rate × dt 与要求步数之差的最大值
+static double planStepError(MotionPlanner::Profile profile, int &cases)
+{
+    MotionPlanner planner;
+    MotionPlanner::Plan plan;
+    double worst = 0.0;
+    cases = 0;
+    for (int steps = 1; steps <= 5000; steps += steps < 100 ? 1 : steps / 10)
+    {
+        for (double rate : {1.0, 10.0, 66.0, 200.0, 1000.0, 3000.0})
+        {
+            for (double accel : {165.0, 660.0, 5000.0})
+            {
+                planner.planMove(steps, rate, accel, profile, plan);
+                double sum = 0.0;
+                for (const auto &point : plan.points)
+                {
+                    sum += point.rate * point.duration;
+                }
+                worst = max(worst, abs(sum - steps));
+                cases++;
+            }
+        }
+    }
+    return worst;
+}
+
+// 一次回抽的结果
+struct RetractResult
+{
+    bool valid = false;
+    double stepError = 0.0;     // 实际微步数 - 规划微步数
+    double duration = 0.0;      // 首个非零频率到频率0的时长 (s)
+    vector<double> releaseError; // 各频率命令相对首条命令的时刻与规划时刻之差 (ms)
+};
+
+static RetractResult retractRun(MotorDriver &motor, MotorBackend_Sim &sim, const MotionPlanner::Plan &plan)
+{
+    RetractResult result;
+    motor.setMotorState(IDLE);
+    this_thread::sleep_for(chrono::milliseconds(20));
+    sim.clearCommands();
+    sim.resetSteps();
+
+    motor.setMotorState(EMERGENCY_STOP);
+    this_thread::sleep_for(chrono::milliseconds(20));
+    for (int wait = 0; motor.isMoving() && wait < 1000; ++wait)
+    {
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    this_thread::sleep_for(chrono::milliseconds(20));
+
+    // 正向输液的回抽为反向，仿真后端的步数为负
+    result.stepError = -sim.getFullSteps() * retractMicrostep - retractSteps;
+
+    // 频率相同的相邻规划点只下发一次，按频率变化逐条对应
+    vector<double> planned;
+    double applied = 0.0;
+    double elapsed = 0.0;
+    for (const auto &point : plan.points)
+    {
+        if (point.rate != applied)
+        {
+            planned.push_back(elapsed);
+            applied = point.rate;
+        }
+        elapsed += point.duration;
+    }
+
+    vector<chrono::steady_clock::time_point> released;
+    for (const auto &command : sim.getCommands())
+    {
+        if (command.type == MotorBackend_Sim::Command::FREQUENCY && !command.failed)
+            released.push_back(command.time);
+    }
+    if (released.size() != planned.size())
+        return result;
+
+    for (size_t i = 0; i < released.size(); ++i)
+    {
+        double actual = chrono::duration<double>(released[i] - released.front()).count();
+        result.releaseError.push_back((actual - planned[i]) * 1000.0);
+    }
+    result.duration = chrono::duration<double>(released.back() - released.front()).count();
+    result.valid = true;
+    return result;
+}
+
+static bool timingScenario()
+{
+    bool ok = true;
+    cout << scientific << setprecision(1);
+    for (MotionPlanner::Profile profile : {MotionPlanner::TRAPEZOIDAL, MotionPlanner::S_CURVE})
+    {
+        int cases = 0;
+        double worst = planStepError(profile, cases);
+        cout << (profile == MotionPlanner::S_CURVE ? "S形" : "梯形") << " 规划步数: " << cases << " 组 (步数, 步频, 加速度)，"
+             << "Σ rate·dt 与步数之差最大 " << worst << endl;
+        ok = ok && worst < 1e-9;
+    }
+
+    MotionPlanner planner;
+    MotionPlanner::Plan plan;
+    planner.planMove(retractSteps, retractRate, retractAccel, MotionPlanner::S_CURVE, plan);
+
+    auto sim = make_shared<MotorBackend_Sim>(1, false, commandCapacity);
+    PumpState pumpState;
+    PumpParams pumpParams;
+    atomic<bool> paramsUpdated{false};
+    pumpParams.direction = true;
+    MotorDriver motor(sim, pumpState);
+    if (!motor.initialize())
+    {
+        cout << "初始化失败" << endl;
+        return false;
+    }
+    motor.startControlThread(pumpParams, paramsUpdated);
+
+    const int runs = 100;
+    vector<double> stepError;
+    vector<double> duration;
+    vector<double> releaseError;
+    int invalid = 0;
+    for (int i = 0; i < runs; ++i)
+    {
+        RetractResult result = retractRun(motor, *sim, plan);
+        if (!result.valid)
+        {
+            invalid++;
+            continue;
+        }
+        stepError.push_back(result.stepError);
+        duration.push_back(result.duration);
+        for (double error : result.releaseError)
+        {
+            releaseError.push_back(abs(error));
+        }
+    }
+    motor.setMotorState(IDLE);
+    motor.stopControlThread();
+
+    if (stepError.empty())
+    {
+        cout << "回抽: 命令序列与规划不符 " << invalid << "/" << runs << endl;
+        return false;
+    }
+    cout << fixed << setprecision(4) << "回抽 " << retractSteps << " 微步 x" << stepError.size() << ": 步数误差 中位 "
+         << percentile(stepError, 0.5) << " 最小 " << percentile(stepError, 0.0) << " 最大 "
+         << percentile(stepError, 1.0) << " 微步" << endl;
+    cout << "回抽时长: 规划 " << plan.duration << " s 中位 " << percentile(duration, 0.5) << " s 最大 "
+         << percentile(duration, 1.0) << " s" << endl;
+    cout << setprecision(3) << "规划点下发时刻误差: 中位 " << percentile(releaseError, 0.5) << " ms p99 "
+         << percentile(releaseError, 0.99) << " ms 最大 " << percentile(releaseError, 1.0) << " ms" << endl;
+    if (invalid > 0)
+        cout << "命令序列与规划不符: " << invalid << "/" << runs << endl;
+
+    // 宿主机调度噪声会推迟个别点的下发；中位数反映按绝对时刻等待是否累积误差
+    double worstStep = max(-percentile(stepError, 0.0), percentile(stepError, 1.0));
+    return ok && invalid == 0 && worstStep < retractStepTolerance &&
+           percentile(releaseError, 0.5) < releaseMedianLimit &&
+           abs(percentile(duration, 0.5) - plan.duration) < plan.duration * 0.01;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+
+    // 注入的写入失败由驱动按error记录，仿真中只输出critical
+    InfusionLogger::init("motor_driver_sim.log", InfusionLogger::CRITICAL, 1048576, 1, true, false);
+    string scenario = argv[1];
+    bool ok;
+    if (scenario == "dose")
+    {
+        ok = doseScenario();
+    }
+    else if (scenario == "latency")
+    {
+        ok = latencyScenario();
+    }
+    else if (scenario == "timing")
+    {
+        ok = timingScenario();
+    }
+    else
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+    cout << (ok ? "通过" : "失败") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file motor_gpiod.cpp
+ * @note libgpiod + pwm_beeper 电机后端实现
+ */
+#include <motor_hal/motor_gpiod.hpp>
+#include "logger.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <linux/input.h>
+
+namespace MotorHAL
+{
+    MotorBackend_Gpiod::MotorBackend_Gpiod(const char *chipname, int dirPin, const int microPins[3],
+                                           const char *pwmDevice)
+        : chipname_(chipname), dirPin_(dirPin), pwmDevice_(pwmDevice)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            microPins_[i] = microPins[i];
+        }
+        gpiod_line_bulk_init(&outputLines_);
+    }
+
+    MotorBackend_Gpiod::~MotorBackend_Gpiod()
+    {
+        close();
+    }
+
+    bool MotorBackend_Gpiod::open()
+    {
+        // 打开GPIO芯片
+        chip_ = gpiod_chip_open_by_name(chipname_);
+        if (!chip_)
+        {
+            InfusionLogger::error("打开GPIO芯片失败");
+            return false;
+        }
+
+        // 获取方向控制引脚与细分控制引脚，作为一组批量请求，每次变化用一次ioctl同时写入
+        gpiod_line_bulk_init(&outputLines_);
+        dirLine_ = gpiod_chip_get_line(chip_, dirPin_);
+        if (!dirLine_)
+        {
+            InfusionLogger::error("获取方向GPIO失败");
+            return false;
+        }
+        gpiod_line_bulk_add(&outputLines_, dirLine_);
+
+        for (int i = 0; i < 3; i++)
+        {
+            microLines_[i] = gpiod_chip_get_line(chip_, microPins_[i]);
+            if (!microLines_[i])
+            {
+                InfusionLogger::error("获取细分控制GPIO失败");
+                return false;
+            }
+            gpiod_line_bulk_add(&outputLines_, microLines_[i]);
+        }
+
+        const int defaults[4] = {0, 0, 0, 0};
+        if (gpiod_line_request_bulk_output(&outputLines_, "MotorDriver", defaults) < 0)
+        {
+            InfusionLogger::error("请求方向与细分控制GPIO输出模式失败");
+            return false;
+        }
+
+        if (!openPulse())
+            return false;
+
+        isOpened = true;
+        return true;
+    }
+
+    bool MotorBackend_Gpiod::openPulse()
+    {
+        // 开启PWM
+        pwm_fd_ = ::open(pwmDevice_, O_RDWR);
+        if (pwm_fd_ < 0)
+        {
+            InfusionLogger::error("打开电机PWM设备失败");
+            return false;
+        }
+        return true;
+    }
+
+    void MotorBackend_Gpiod::closePulse()
+    {
+        // 关闭PWM设备
+        if (pwm_fd_ >= 0)
+        {
+            ::close(pwm_fd_);
+            pwm_fd_ = -1;
+        }
+    }
+
+    bool MotorBackend_Gpiod::writeOutputs(int direction, int microstepBits)
+    {
+        // 顺序与open中加入批量的顺序一致：方向、细分位0、位1、位2
+        const int values[4] = {direction, microstepBits & 0x1, (microstepBits >> 1) & 0x1, (microstepBits >> 2) & 0x1};
+        if (gpiod_line_set_value_bulk(&outputLines_, values) < 0)
+        {
+            lastError = errno;
+            return false;
+        }
+        return true;
+    }
+
+    bool MotorBackend_Gpiod::writeFrequency(double frequency)
+    {
+        // pwm_beeper只接受整数Hz
+        struct input_event event;
+        memset(&event, 0, sizeof(event));
+        event.type = EV_SND;
+        event.code = SND_TONE;
+        event.value = static_cast<int>(std::lround(frequency));
+        ssize_t written = write(pwm_fd_, &event, sizeof(event));
+        if (written != sizeof(event))
+        {
+            lastError = written < 0 ? errno : EIO; // 短写不设errno
+            return false;
+        }
+        return true;
+    }
+
+    void MotorBackend_Gpiod::close()
+    {
+        closePulse();
+
+        // 释放GPIO资源
+        if (chip_)
+        {
+            gpiod_chip_close(chip_);
+            chip_ = nullptr;
+        }
+        dirLine_ = nullptr;
+        isOpened = false;
+    }
+} // namespace MotorHAL
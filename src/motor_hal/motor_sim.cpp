@@ -0,0 +1,156 @@
+/**
+ * @file motor_sim.cpp
+ * @note 仿真电机后端实现
+ */
+#include <motor_hal/motor_sim.hpp>
+#include <thread>
+
+namespace MotorHAL
+{
+    MotorBackend_Sim::MotorBackend_Sim(unsigned seed, bool fractional, size_t commandCapacity)
+        : fractional_(fractional), commands_(commandCapacity), rng_(seed)
+    {
+    }
+
+    bool MotorBackend_Sim::open()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        direction_ = 0;
+        microstepBits_ = 0;
+        frequency_ = 0.0;
+        segmentStart_ = std::chrono::steady_clock::now();
+        isOpened = true;
+        return true;
+    }
+
+    bool MotorBackend_Sim::injectFault(std::unique_lock<std::mutex> &lock)
+    {
+        writes_++;
+        auto delay = faults_.writeDelay;
+        if (faults_.writeJitter.count() > 0)
+        {
+            std::uniform_int_distribution<long long> jitter(0, faults_.writeJitter.count());
+            delay += std::chrono::microseconds(jitter(rng_));
+        }
+        bool fail = faults_.failEvery > 0 && writes_ % faults_.failEvery == 0;
+        if (faults_.failProbability > 0)
+        {
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            fail = fail || uniform(rng_) < faults_.failProbability;
+        }
+
+        // 模拟阻塞在系统调用中，等待期间不占用仿真状态锁
+        if (delay.count() > 0)
+        {
+            lock.unlock();
+            std::this_thread::sleep_for(delay);
+            lock.lock();
+        }
+        return fail;
+    }
+
+    void MotorBackend_Sim::record(const Command &command)
+    {
+        if (commands_.empty())
+            return;
+        commands_[commandCount_ % commands_.size()] = command;
+        commandCount_++;
+    }
+
+    double MotorBackend_Sim::segmentSteps(std::chrono::steady_clock::time_point now) const
+    {
+        double seconds = std::chrono::duration<double>(now - segmentStart_).count();
+        double steps = frequency_ * seconds / (1 << microstepBits_);
+        return direction_ == 1 ? steps : -steps;
+    }
+
+    bool MotorBackend_Sim::writeOutputs(int direction, int microstepBits)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool fail = injectFault(lock);
+        auto now = std::chrono::steady_clock::now();
+        record({Command::OUTPUTS, now, direction, microstepBits, 0.0, fail});
+        if (fail)
+            return false;
+
+        fullSteps_ += segmentSteps(now);
+        segmentStart_ = now;
+        direction_ = direction;
+        microstepBits_ = microstepBits;
+        return true;
+    }
+
+    bool MotorBackend_Sim::writeFrequency(double frequency)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool fail = injectFault(lock);
+        auto now = std::chrono::steady_clock::now();
+        record({Command::FREQUENCY, now, -1, -1, frequency, fail});
+        if (fail)
+            return false;
+
+        fullSteps_ += segmentSteps(now);
+        segmentStart_ = now;
+        frequency_ = frequency;
+        return true;
+    }
+
+    void MotorBackend_Sim::close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        fullSteps_ += segmentSteps(now);
+        segmentStart_ = now;
+        frequency_ = 0.0;
+        isOpened = false;
+    }
+
+    void MotorBackend_Sim::setFaults(const Faults &faults)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        faults_ = faults;
+        writes_ = 0;
+    }
+
+    std::vector<MotorBackend_Sim::Command> MotorBackend_Sim::getCommands() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Command> commands;
+        size_t capacity = commands_.size();
+        uint64_t first = commandCount_ > capacity ? commandCount_ - capacity : 0;
+        commands.reserve(commandCount_ - first);
+        for (uint64_t i = first; i < commandCount_; i++)
+            commands.push_back(commands_[i % capacity]);
+        return commands;
+    }
+
+    uint64_t MotorBackend_Sim::getDroppedCommands() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return commandCount_ > commands_.size() ? commandCount_ - commands_.size() : 0;
+    }
+
+    void MotorBackend_Sim::clearCommands()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commandCount_ = 0;
+    }
+
+    double MotorBackend_Sim::getFullSteps() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return fullSteps_ + segmentSteps(std::chrono::steady_clock::now());
+    }
+
+    double MotorBackend_Sim::getRevolutions() const
+    {
+        return getFullSteps() / stepsPerRevolution_;
+    }
+
+    void MotorBackend_Sim::resetSteps()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fullSteps_ = 0.0;
+        segmentStart_ = std::chrono::steady_clock::now();
+    }
+} // namespace MotorHAL
@@ -0,0 +1,196 @@
+/**
+ * @file motor_sysfs_pwm.cpp
+ * @note libgpiod + sysfs PWM 电机后端实现
+ */
+#include <motor_hal/motor_sysfs_pwm.hpp>
+#include "logger.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+namespace MotorHAL
+{
+    MotorBackend_SysfsPwm::MotorBackend_SysfsPwm(const char *chipname, int dirPin, const int microPins[3],
+                                                 const std::string &pwmChip, int channel)
+        : MotorBackend_Gpiod(chipname, dirPin, microPins, nullptr), chipPath_(pwmChip), channel_(channel),
+          channelPath_(pwmChip + "/pwm" + std::to_string(channel))
+    {
+    }
+
+    MotorBackend_SysfsPwm::~MotorBackend_SysfsPwm()
+    {
+        close();
+    }
+
+    bool MotorBackend_SysfsPwm::writeValue(int fd, long long value)
+    {
+        // 以换行结尾，内核解析时忽略；在普通文件上覆盖较长的旧值时读取方也能正确截断
+        // 用栈上缓冲格式化，控制线程中不分配内存
+        char text[32];
+        int length = snprintf(text, sizeof(text), "%lld\n", value);
+        ssize_t written = pwrite(fd, text, length, 0);
+        if (written >= 0 && written != length)
+            errno = EIO; // 短写不设errno
+        return written == length;
+    }
+
+    bool MotorBackend_SysfsPwm::writeFile(const std::string &path, long long value)
+    {
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd < 0)
+            return false;
+        bool ok = writeValue(fd, value);
+        ::close(fd);
+        return ok;
+    }
+
+    bool MotorBackend_SysfsPwm::readFile(const std::string &path, long long &value)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        char text[32];
+        ssize_t length = read(fd, text, sizeof(text) - 1);
+        ::close(fd);
+        if (length <= 0)
+            return false;
+        text[length] = '\0';
+        return sscanf(text, "%lld", &value) == 1;
+    }
+
+    bool MotorBackend_SysfsPwm::openPulse()
+    {
+        // 通道未导出时先导出，等待内核创建目录并由udev调整权限
+        if (access(channelPath_.c_str(), F_OK) != 0)
+        {
+            if (!writeFile(chipPath_ + "/export", channel_))
+            {
+                InfusionLogger::error("导出PWM通道失败: {}/export ({})", chipPath_, strerror(errno));
+                return false;
+            }
+            exported_ = true;
+        }
+        std::string periodPath = channelPath_ + "/period";
+        for (int i = 0; i < 100 && access(periodPath.c_str(), W_OK) != 0; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        periodFd_ = ::open(periodPath.c_str(), O_WRONLY);
+        dutyFd_ = ::open((channelPath_ + "/duty_cycle").c_str(), O_WRONLY);
+        enableFd_ = ::open((channelPath_ + "/enable").c_str(), O_WRONLY);
+        if (periodFd_ < 0 || dutyFd_ < 0 || enableFd_ < 0)
+        {
+            InfusionLogger::error("打开PWM通道属性失败: {} ({})", channelPath_, strerror(errno));
+            closePulse();
+            return false;
+        }
+
+        // 新导出的通道周期为0，内核拒绝周期为0的任何配置（包括关闭输出与写占空比），
+        // 此时占空比也为0，先写入一个合法周期
+        long long period = -1;
+        if (!readFile(periodPath, period))
+        {
+            InfusionLogger::error("读取PWM周期失败: {} ({})", periodPath, strerror(errno));
+            closePulse();
+            return false;
+        }
+        if (period == 0 && !writeValue(periodFd_, initialPeriodNs_))
+        {
+            InfusionLogger::error("写入PWM初始周期失败: {} ({})", periodPath, strerror(errno));
+            closePulse();
+            return false;
+        }
+
+        // 初始为停止；占空比清零后任意周期都合法
+        enabled_ = true;
+        periodNs_ = 0;
+        if (!writeFrequency(0) || !writeValue(dutyFd_, 0))
+        {
+            InfusionLogger::error("初始化PWM通道失败: {}", channelPath_);
+            closePulse();
+            return false;
+        }
+        InfusionLogger::info("步进脉冲使用PWM通道: {}", channelPath_);
+        return true;
+    }
+
+    bool MotorBackend_SysfsPwm::writeFrequency(double frequency)
+    {
+        if (frequency <= 0)
+        {
+            if (enabled_ && !writeValue(enableFd_, 0))
+            {
+                lastError = errno;
+                return false;
+            }
+            enabled_ = false;
+            return true;
+        }
+
+        long long period = std::llround(1e9 / frequency);
+        long long duty = period / 2;
+        if (period != periodNs_)
+        {
+            // 周期变长时先写周期，变短时先写占空比，保证任一时刻占空比不超过周期
+            bool ok;
+            if (periodNs_ < 0)
+                ok = writeValue(dutyFd_, 0) && writeValue(periodFd_, period) && writeValue(dutyFd_, duty);
+            else if (period > periodNs_)
+                ok = writeValue(periodFd_, period) && writeValue(dutyFd_, duty);
+            else
+                ok = writeValue(dutyFd_, duty) && writeValue(periodFd_, period);
+            if (!ok)
+            {
+                lastError = errno;
+                periodNs_ = -1; // 写入中途失败，两个属性的实际值未知，下次先清零占空比再写
+                return false;
+            }
+            periodNs_ = period;
+        }
+
+        if (!enabled_)
+        {
+            if (!writeValue(enableFd_, 1))
+            {
+                lastError = errno;
+                return false;
+            }
+            enabled_ = true;
+        }
+        return true;
+    }
+
+    void MotorBackend_SysfsPwm::closePulse()
+    {
+        if (enableFd_ >= 0)
+        {
+            writeValue(enableFd_, 0);
+            ::close(enableFd_);
+            enableFd_ = -1;
+        }
+        if (dutyFd_ >= 0)
+        {
+            ::close(dutyFd_);
+            dutyFd_ = -1;
+        }
+        if (periodFd_ >= 0)
+        {
+            ::close(periodFd_);
+            periodFd_ = -1;
+        }
+        enabled_ = false;
+        periodNs_ = 0;
+
+        if (exported_)
+        {
+            writeFile(chipPath_ + "/unexport", channel_);
+            exported_ = false;
+        }
+    }
+} // namespace MotorHAL
@@ -166,6 +166,20 @@ void MQTTHandler::handleAttributeMessage(mqtt::const_message_ptr msg, PumpParams
         {
             pumpParams.target_flow_rate.store(std::stod(std::string(item.value())));
         }
+        else if (key == "bottle_volume")
+        {
+            double volume = item.value().is_string() ? std::stod(item.value().get<std::string>())
+                                                     : item.value().get<double>();
+            if (volume > 0)
+                pumpParams.bottle_volume.store(volume);
+        }
+        else if (key == "vtbi")
+        {
+            double vtbi = item.value().is_string() ? std::stod(item.value().get<std::string>())
+                                                   : item.value().get<double>();
+            if (vtbi >= 0)
+                pumpParams.vtbi.store(vtbi);
+        }
     }
 }
 
@@ -1,5 +1,7 @@
 #include "mqtt_thread_manager.hpp"
 #include "logger.hpp"
+#include "liquid_detector.hpp"
+#include "flow_monitor.hpp"
 #include <thread>
 #include <chrono>
 
@@ -78,14 +80,24 @@ void MQTTThreadManager::mqttThread()
                 else if (msg->get_topic().find("v1/devices/me/attributes") != std::string::npos)
                 {
                     mqttHandler_.handleAttributeMessage(msg, pumpParams_);
-                    paramsUpdatedFlag_.store(true);
+
+                    // 标定期间转速由标定器控制，不按流量改写，也不触发参数更新
+                    bool calibrating = pumpState_.state.load() == CALIBRATING;
+                    if (calibrating)
+                    {
+                        InfusionLogger::info("标定进行中，属性更新暂不应用于电机转速");
+                    }
+                    else
+                    {
+                        paramsUpdatedFlag_.store(true);
+                    }
 
                     // 当参数更新时，使用泵数据库将流量转换为转速
                     double targetFlowRate = pumpParams_.target_flow_rate.load();
-                    if (targetFlowRate >= 0 && pumpDatabase_ && !pumpName_.empty() && motorDriver_)
+                    if (!calibrating && targetFlowRate >= 0 && pump_ && motorDriver_)
                     {
                         // 计算目标转速
-                        double targetRPM = pumpDatabase_->calculateRPM(pumpName_, targetFlowRate);
+                        double targetRPM = PumpDatabase::calculateRPM(*pump_, targetFlowRate);
 
                         // 设置电机转速
                         InfusionLogger::info("将目标流量 {:.2f} ml/h 转换为转速 {:.2f} RPM",
@@ -93,6 +105,10 @@ void MQTTThreadManager::mqttThread()
 
                         pumpParams_.target_rpm.store(targetRPM);
                     }
+                    if (!calibrating && motorDriver_)
+                    {
+                        motorDriver_->notify();
+                    }
                 }
             }
 
@@ -130,6 +146,14 @@ void MQTTThreadManager::mqttThread()
                 {
                     json liquidTelemetry;
                     liquidTelemetry["progress"] = liquidLevel;
+                    liquidTelemetry["remaining_time"] = pumpState_.remaining_time.load();
+                    liquidTelemetry["remaining_time_low"] = pumpState_.remaining_time_low.load();
+                    liquidTelemetry["remaining_time_high"] = pumpState_.remaining_time_high.load();
+                    liquidTelemetry["dry_early_warning"] = pumpState_.dry_early_warning.load();
+                    liquidTelemetry["measured_flow_rate"] = pumpState_.measured_flow_rate.load();
+                    liquidTelemetry["flow_trim"] = pumpState_.flow_trim.load();
+                    liquidTelemetry["flow_alarm"] =
+                        FlowMonitor::alarmName(static_cast<FlowMonitor::Alarm>(pumpState_.flow_alarm.load()));
                     mqttHandler_.sendTelemetry(liquidTelemetry);
                 }
                 else
@@ -137,6 +161,20 @@ void MQTTThreadManager::mqttThread()
                     InfusionLogger::warn("液位百分比无效: {}%", liquidLevel);
                 }
 
+                // 发送相机占空比统计，结合电池功率对比开启/关闭占空比的功耗
+                CameraManager::DutyCycleStats dutyStats = cameraManager_.getDutyCycleStats();
+                json cameraTelemetry;
+                cameraTelemetry["camera_duty_cycling"] = dutyStats.duty_cycling;
+                cameraTelemetry["camera_streaming_ratio"] = dutyStats.streaming_ratio;
+                cameraTelemetry["camera_wake_latency_ms"] = dutyStats.avg_wake_latency_ms;
+                cameraTelemetry["cpu_usage"] = dutyStats.cpu_usage;
+                // 液位线跟踪命中率及跟踪/全图扫描耗时
+                LevelDetectionStats levelStats = cameraManager_.getLevelDetectionStats();
+                cameraTelemetry["level_tracked_ratio"] = levelStats.tracked_ratio;
+                cameraTelemetry["level_tracked_latency_ms"] = levelStats.tracked_latency_ms;
+                cameraTelemetry["level_full_scan_latency_ms"] = levelStats.full_scan_latency_ms;
+                mqttHandler_.sendTelemetry(cameraTelemetry);
+
                 // 发送泵转速和流量
                 double currentSpeed = 0.0;
                 double currentFlowRate = 0.0;
@@ -146,9 +184,9 @@ void MQTTThreadManager::mqttThread()
                     currentSpeed = motorDriver_->getSpeed();
 
                     // 如果有泵数据库，计算当前流量
-                    if (pumpDatabase_ && !pumpName_.empty())
+                    if (pump_)
                     {
-                        currentFlowRate = pumpDatabase_->calculateFlowRate(pumpName_, currentSpeed);
+                        currentFlowRate = PumpDatabase::calculateFlowRate(*pump_, currentSpeed);
                     }
                 }
 
@@ -189,6 +227,9 @@ void MQTTThreadManager::mqttThread()
                 case ERROR:
                     pumpStateString = "ERROR";
                     break;
+                case CALIBRATING:
+                    pumpStateString = "CALIBRATING";
+                    break;
                 default:
                     pumpStateString = "UNKNOWN";
                     break;
@@ -196,6 +237,13 @@ void MQTTThreadManager::mqttThread()
 
                 // 发送泵状态信息
                 mqttHandler_.sendPumpStateTelemetry(currentFlowRate, currentSpeed, pumpStateString);
+
+                // 发送已输注量与待输注量
+                json doseTelemetry;
+                doseTelemetry["delivered_volume"] = pumpState_.delivered_volume.load();
+                doseTelemetry["vtbi"] = pumpParams_.vtbi.load();
+                doseTelemetry["vtbi_reached"] = pumpState_.vtbi_reached.load();
+                mqttHandler_.sendTelemetry(doseTelemetry);
                 InfusionLogger::debug(
                     "已发送泵状态 - 流量: {:.2f} ml/h, 转速: {:.2f} RPM",
                     currentFlowRate, currentSpeed);
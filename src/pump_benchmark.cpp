@@ -0,0 +1,199 @@
+// 泵数据库基准：统计流量模型单次求值的耗时与内存分配次数，以及大数据库的加载与按名称查找耗时
+#include "pump_database.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 统计全局内存分配次数，验证求值路径不分配内存
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+static void showHelp(const char *programName)
+{
+    cout << "用法: " << programName << " <泵数据文件> <泵名称> [选项]" << endl;
+    cout << "      " << programName << " --generate=N <输出文件>" << endl;
+    cout << "选项:" << endl;
+    cout << "  --calls=N       每项计时的调用次数（默认: 10000000）" << endl;
+    cout << "  --lookup        另测加载、按名称查找与增删泵的耗时" << endl;
+    cout << "  --generate=N    生成N个泵的合成数据文件后退出" << endl;
+}
+
+// 对fn计时N次，输出每次调用的纳秒数与分配次数
+template <typename Fn>
+static void measure(const string &label, int calls, Fn fn)
+{
+    volatile double sink = 0.0;
+    size_t before = allocations;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i)
+    {
+        sink = sink + fn(i);
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / calls;
+    cout << left << setw(32) << label << fixed << setprecision(1) << setw(10) << ns << setw(10)
+         << allocations - before << endl;
+}
+
+// 合成数据：每个泵6个测量点，流量约为转速的10-14倍并带±3%噪声，名称形如 pump-00042-tube-C
+static int generate(int count, const string &fileName)
+{
+    PumpDatabase db;
+    mt19937 rng(1);
+    uniform_real_distribution<double> gain(10.0, 14.0);
+    uniform_real_distribution<double> noise(0.97, 1.03);
+    const double rpms[] = {60.0, 56.2, 7.0, 6.0, 0.6, 0.06};
+    for (int i = 0; i < count; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "pump-%05d-tube-%c", i, 'A' + i % 4);
+        PumpData pd;
+        pd.pump_name = name;
+        double k = gain(rng);
+        for (double rpm : rpms)
+        {
+            pd.rpm_flow_points.emplace_back(rpm, k * rpm * noise(rng));
+        }
+        db.addPump(pd);
+    }
+    if (!db.saveToFile(fileName))
+    {
+        cerr << "无法写入: " << fileName << endl;
+        return 1;
+    }
+    cout << "已生成 " << count << " 个泵: " << fileName << endl;
+    return 0;
+}
+
+// 加载、按名称查找与增删泵；查找的名称随机选取，避免只命中缓存中的少数几项
+static void lookup(PumpDatabase &db, const string &fileName, int calls)
+{
+    double bestLoad = 1e9;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto start = chrono::steady_clock::now();
+        db.loadFromFile(fileName);
+        bestLoad = min(bestLoad, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    vector<string> names;
+    for (const auto &pump : db.getPumps())
+    {
+        names.push_back(pump->pump_name);
+    }
+    cout << "泵数量 " << names.size() << "，加载 " << fixed << setprecision(1) << bestLoad << " ms" << endl;
+    if (names.empty())
+        return;
+
+    mt19937 rng(3);
+    vector<size_t> order(1 << 16);
+    for (auto &i : order)
+    {
+        i = rng() % names.size();
+    }
+
+    cout << left << setw(32) << "调用" << setw(10) << "ns/次" << setw(10) << "分配" << endl;
+    measure("getPump(名称)", calls, [&](int i)
+            { return db.getPump(names[order[i & 0xffff]]) != nullptr ? 1.0 : 0.0; });
+    measure("calculateFlowRate(随机名称)", calls, [&](int i)
+            { return db.calculateFlowRate(names[order[i & 0xffff]], 30.0); });
+
+    PumpData extra;
+    extra.pump_name = "benchmark-extra";
+    extra.rpm_flow_points = {{60.0, 700.0}, {6.0, 70.0}, {0.6, 7.0}};
+    measure("addPump+removePump", 1000, [&](int)
+            { return db.addPump(extra) && db.removePump(extra.pump_name) ? 1.0 : 0.0; });
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        showHelp(argv[0]);
+        return 1;
+    }
+
+    string fileName = argv[1];
+    if (fileName.find("--generate=") == 0)
+    {
+        return generate(max(1, atoi(fileName.substr(11).c_str())), argv[2]);
+    }
+
+    string pumpName = argv[2];
+    int calls = 10000000;
+    bool lookupEnabled = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.find("--calls=") == 0)
+        {
+            calls = max(1, atoi(arg.substr(8).c_str()));
+        }
+        else if (arg == "--lookup")
+        {
+            lookupEnabled = true;
+        }
+        else
+        {
+            showHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    PumpDatabase db(fileName);
+    if (lookupEnabled)
+    {
+        // 重新加载会使句柄失效，先于句柄取得
+        lookup(db, fileName, calls);
+    }
+    const PumpHandle *handle = db.getHandle(pumpName);
+    if (!handle)
+    {
+        cerr << "无法找到泵名称: " << pumpName << endl;
+        return 1;
+    }
+    PumpSnapshot snapshot = handle->load();
+    cout << "流量模型: " << (snapshot->flow_model.type == FlowModel::PCHIP ? "pchip" : "polynomial")
+         << "，测量点 " << snapshot->rpm_flow_points.size() << " 个" << endl;
+
+    // 转速0-150 RPM、流量0-750 ml/h循环取值
+    cout << left << setw(32) << "调用" << setw(10) << "ns/次" << setw(10) << "分配" << endl;
+    measure("calculateFlowRate(名称)", calls, [&](int i)
+            { return db.calculateFlowRate(pumpName, (i % 1500) * 0.1); });
+    measure("calculateRPM(名称)", calls, [&](int i)
+            { return db.calculateRPM(pumpName, (i % 1500) * 0.5); });
+    measure("calculateFlowRate(句柄)", calls, [&](int i)
+            { return PumpDatabase::calculateFlowRate(*handle, (i % 1500) * 0.1); });
+    measure("calculateRPM(句柄)", calls, [&](int i)
+            { return PumpDatabase::calculateRPM(*handle, (i % 1500) * 0.5); });
+    measure("calculateFlowRate(快照)", calls, [&](int i)
+            { return PumpDatabase::calculateFlowRate(*snapshot, (i % 1500) * 0.1); });
+    measure("calculateRPM(快照)", calls, [&](int i)
+            { return PumpDatabase::calculateRPM(*snapshot, (i % 1500) * 0.5); });
+    return 0;
+}
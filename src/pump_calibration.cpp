@@ -71,8 +71,7 @@ void addPump()
 
     if (pump_db.addPump(new_pump))
     {
-        pump_db.saveToFile();
-        cout << "Pump data saved." << endl;
+        cout << (pump_db.saveToFile() ? "Pump data saved." : "Failed to save pump data.") << endl;
     }
     else
     {
@@ -84,8 +83,7 @@ void deletePump(string pump_name)
 {
     if (pump_db.removePump(pump_name))
     {
-        pump_db.saveToFile();
-        cout << "Pump deleted." << endl;
+        cout << (pump_db.saveToFile() ? "Pump deleted." : "Failed to save pump data.") << endl;
     }
     else
     {
@@ -121,7 +119,7 @@ void calculateRPM(string pump_name, double target_flow_rate)
 
 void dumpPumpData(string pump_name)
 {
-    const PumpData *pump_data = pump_db.getPump(pump_name);
+    PumpSnapshot pump_data = pump_db.getPump(pump_name);
     if (pump_data)
     {
         cout << "Pump name: " << pump_data->pump_name << endl;
@@ -180,12 +178,14 @@ void pumpMenu(string pump_name)
         {
             cout << "Please input RPM-Flow Rate pairs. First RPM next Flow Rate. Enter 'q' to finish.\n";
             vector<FlowRPMPoint> rpm_flow_points = getRPMFlowPointsFromCin();
-            PumpData *pump = pump_db.findPump(pump_name);
+            PumpSnapshot pump = pump_db.getPump(pump_name);
             if (pump)
             {
-                pump->rpm_flow_points.insert(pump->rpm_flow_points.end(), rpm_flow_points.begin(), rpm_flow_points.end());
-                pump_db.saveToFile();
-                cout << "Pump data updated." << endl;
+                // 通过updatePump提交，使流量模型重新拟合
+                PumpData updated = *pump;
+                updated.rpm_flow_points.insert(updated.rpm_flow_points.end(), rpm_flow_points.begin(), rpm_flow_points.end());
+                pump_db.updatePump(updated);
+                cout << (pump_db.saveToFile() ? "Pump data updated." : "Failed to save pump data.") << endl;
             }
             else
             {
@@ -254,15 +254,15 @@ void mainMenu()
             else
             {
                 cout << "Available pumps:\n";
-                for (const auto &pump : *pump_db.getPumps())
+                for (const auto &pump : pump_db.getPumps())
                 {
-                    cout << pump.pump_name << endl;
+                    cout << pump->pump_name << endl;
                 }
 
                 cout << "Select pump name: ";
                 string pump_choice;
                 cin >> pump_choice;
-                if (pump_db.findPump(pump_choice))
+                if (pump_db.getPump(pump_choice))
                 {
                     pumpMenu(pump_choice);
                 }
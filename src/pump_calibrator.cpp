@@ -0,0 +1,314 @@
+#include "pump_calibrator.hpp"
+#include "infusion_state_machine.hpp"
+#include "logger.hpp"
+#include "motor_driver.hpp"
+#include <algorithm>
+#include <cmath>
+
+PumpCalibrator::BottleProfile PumpCalibrator::BottleProfile::linear(double volume)
+{
+    BottleProfile profile;
+    profile.points = {{0.0, 0.0}, {100.0, volume}};
+    return profile;
+}
+
+double PumpCalibrator::BottleProfile::volumeAt(double level) const
+{
+    if (points.empty())
+        return 0.0;
+    if (level <= points.front().first)
+        return points.front().second;
+    if (level >= points.back().first)
+        return points.back().second;
+
+    auto it = std::lower_bound(points.begin(), points.end(), level,
+                               [](const std::pair<double, double> &p, double l)
+                               { return p.first < l; });
+    const auto &hi = *it;
+    const auto &lo = *(it - 1);
+    return lo.second + (level - lo.first) * (hi.second - lo.second) / (hi.first - lo.first);
+}
+
+PumpCalibrator::PumpCalibrator(InfusionStateMachine &stateMachine, MotorDriver &motorDriver,
+                               PumpParams &pumpParams, std::atomic<bool> &paramsUpdatedFlag,
+                               PumpDatabase &pumpDatabase, const std::string &pumpName)
+    : stateMachine_(stateMachine), motorDriver_(motorDriver), pumpParams_(pumpParams), paramsUpdatedFlag_(paramsUpdatedFlag),
+      pumpDatabase_(pumpDatabase), pumpName_(pumpName)
+{
+}
+
+PumpCalibrator::~PumpCalibrator()
+{
+    cancel();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+bool PumpCalibrator::start(const std::vector<double> &rpms, const BottleProfile &profile,
+                           std::chrono::seconds maxStep)
+{
+    if (running_.load())
+    {
+        InfusionLogger::warn("泵标定已在进行中");
+        return false;
+    }
+    BottleProfile bottle = profile.points.empty() ? BottleProfile::linear(pumpParams_.bottle_volume.load()) : profile;
+    std::sort(bottle.points.begin(), bottle.points.end());
+    if (rpms.empty() || bottle.points.size() < 2 || bottle.points.back().second <= 0)
+    {
+        InfusionLogger::error("泵标定参数无效");
+        return false;
+    }
+    for (double rpm : rpms)
+    {
+        if (rpm <= 0 || rpm > 150)
+        {
+            InfusionLogger::error("泵标定转速超出范围: {} RPM", rpm);
+            return false;
+        }
+    }
+    if (stateMachine_.getState() != IDLE)
+    {
+        InfusionLogger::error("泵需处于空闲状态才能标定");
+        return false;
+    }
+
+    if (thread_.joinable())
+        thread_.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        profile_ = bottle;
+        status_ = Status();
+        status_.phase = "running";
+        status_.total_steps = static_cast<int>(rpms.size());
+        collecting_ = false;
+    }
+
+    stateMachine_.setState(CALIBRATING);
+    if (stateMachine_.getState() != CALIBRATING)
+    {
+        finish("failed", "无法进入标定状态");
+        return false;
+    }
+
+    cancel_ = false;
+    running_ = true;
+    thread_ = std::thread(&PumpCalibrator::run, this, rpms, maxStep);
+    return true;
+}
+
+void PumpCalibrator::cancel()
+{
+    cancel_ = true;
+}
+
+void PumpCalibrator::addLevelSample(double level, std::chrono::steady_clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastLevel_ = level;
+    if (!collecting_ || time < stepStart_)
+        return;
+
+    double t = std::chrono::duration<double>(time - stepStart_).count();
+    sums_.add(t, profile_.volumeAt(level));
+}
+
+PumpCalibrator::Status PumpCalibrator::getStatus() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+void PumpCalibrator::run(std::vector<double> rpms, std::chrono::seconds maxStep)
+{
+    InfusionLogger::info("泵标定开始，共 {} 级", rpms.size());
+
+    std::vector<Step> steps;
+    bool aborted = false;
+    for (size_t i = 0; i < rpms.size(); i++)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.current_step = static_cast<int>(i) + 1;
+        }
+
+        Step step;
+        if (!measureStep(rpms[i], maxStep, step))
+        {
+            aborted = true;
+            break;
+        }
+        steps.push_back(step);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.steps = steps;
+        }
+        InfusionLogger::info("标定第 {} 级: {:.2f} RPM → {:.2f} ml/h (±{:.2f}, {:.0f} 秒)",
+                             i + 1, step.rpm, step.flow_rate, step.flow_stderr, step.duration);
+
+        double level;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            level = lastLevel_;
+        }
+        if (level < minLevel_)
+        {
+            InfusionLogger::warn("液位过低 ({:.1f}%)，提前结束标定", level);
+            break;
+        }
+    }
+
+    // 停止电机
+    pumpParams_.target_rpm.store(0.0);
+    paramsUpdatedFlag_.store(true);
+    motorDriver_.notify();
+
+    // 新曲线保存并发布之前保持CALIBRATING，避免期间按旧曲线开始输注
+    std::string phase = "done";
+    std::string message = "标定完成";
+    if (cancel_.load())
+    {
+        phase = "cancelled";
+        message = "标定已取消";
+    }
+    else if (aborted)
+    {
+        phase = "failed";
+        message = "标定被中断（泵状态已改变）";
+    }
+    else if (std::count_if(steps.begin(), steps.end(), [](const Step &s)
+                           { return s.valid; }) < minPoints_)
+    {
+        phase = "failed";
+        message = "有效测量点不足";
+    }
+    else if (!savePoints(steps))
+    {
+        phase = "failed";
+        message = "保存标定结果失败";
+    }
+
+    if (stateMachine_.getState() == CALIBRATING)
+        stateMachine_.setState(IDLE);
+    finish(phase, message);
+}
+
+bool PumpCalibrator::measureStep(double rpm, std::chrono::seconds maxStep, Step &step)
+{
+    step.rpm = rpm;
+    pumpParams_.target_rpm.store(rpm);
+    paramsUpdatedFlag_.store(true);
+    motorDriver_.notify();
+
+    // 等待转速稳定后开始记录
+    auto settleUntil = std::chrono::steady_clock::now() +
+                       std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(settleSeconds_));
+    bool started = false;
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (cancel_.load() || stateMachine_.getState() != CALIBRATING)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            collecting_ = false;
+            return false;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!started)
+        {
+            if (now < settleUntil)
+                continue;
+            std::lock_guard<std::mutex> lock(mutex_);
+            stepStart_ = now;
+            sums_.clear();
+            collecting_ = true;
+            started = true;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        double elapsed = std::chrono::duration<double>(now - stepStart_).count();
+        RegressionSums::Fit fit = sums_.fit();
+        if (sums_.w >= 3 && fit.valid)
+        {
+            step.flow_rate = -fit.slope * 3600.0;
+            step.flow_stderr = std::sqrt(fit.sigma2 / fit.sxx) * 3600.0;
+            step.samples = static_cast<int>(sums_.w);
+            step.duration = elapsed;
+            step.valid = step.flow_rate > 0 && step.flow_stderr < targetRelError_ * step.flow_rate;
+        }
+
+        bool levelLow = lastLevel_ < minLevel_;
+        if ((step.valid && elapsed >= minStepSeconds_) || elapsed >= maxStep.count() || levelLow)
+        {
+            collecting_ = false;
+            return true;
+        }
+    }
+}
+
+bool PumpCalibrator::savePoints(const std::vector<Step> &steps)
+{
+    PumpSnapshot current = pumpDatabase_.getPump(pumpName_);
+    if (!current)
+        return false;
+
+    PumpData updated = *current;
+    updated.rpm_flow_points.clear();
+    for (const auto &step : steps)
+    {
+        if (step.valid)
+            updated.rpm_flow_points.emplace_back(step.rpm, step.flow_rate);
+    }
+    // 与现有数据文件一致，按转速降序存放
+    std::sort(updated.rpm_flow_points.begin(), updated.rpm_flow_points.end(),
+              [](const FlowRPMPoint &a, const FlowRPMPoint &b)
+              { return a.rpm > b.rpm; });
+
+    if (!pumpDatabase_.updatePump(updated))
+        return false;
+    if (!pumpDatabase_.saveToFile())
+    {
+        // 文件未写入，内存中的曲线也退回标定前，二者保持一致
+        InfusionLogger::error("泵数据文件保存失败，标定结果未生效");
+        pumpDatabase_.updatePump(*current);
+        return false;
+    }
+    // 流量曲线已变，重建电机驱动的流量查找表
+    motorDriver_.refreshFlowModel();
+
+    // 用新拟合曲线回代实测点，评估拟合误差
+    double sum = 0.0;
+    for (const auto &p : updated.rpm_flow_points)
+    {
+        double fitted = pumpDatabase_.calculateFlowRate(pumpName_, p.rpm);
+        double rel = (fitted - p.flow_rate) / p.flow_rate;
+        sum += rel * rel;
+    }
+    double rms = std::sqrt(sum / updated.rpm_flow_points.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_.fit_rms_error = rms;
+    }
+    InfusionLogger::info("标定结果已保存，{} 个点，拟合相对误差 {:.2f}%",
+                         updated.rpm_flow_points.size(), rms * 100.0);
+    return true;
+}
+
+void PumpCalibrator::finish(const std::string &phase, const std::string &message)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_.phase = phase;
+        status_.message = message;
+        collecting_ = false;
+    }
+    running_ = false;
+    if (phase == "done")
+        InfusionLogger::info("泵标定结束: {}", message);
+    else
+        InfusionLogger::warn("泵标定结束: {}", message);
+}
@@ -1,27 +1,99 @@
 #include "pump_database.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-// 自定义GSL错误处理器
-void gsl_error_handler(const char *reason, const char *file, int line, int gsl_errno)
+namespace
 {
-    throw std::runtime_error(std::string("GSL Error: ") + reason);
+// 三次Hermite插值，x落在节点k与k+1之间
+double hermite(const FlowModel &model, size_t k, double x)
+{
+    double h = model.knotRpm[k + 1] - model.knotRpm[k];
+    double t = (x - model.knotRpm[k]) / h;
+    double t2 = t * t;
+    double t3 = t2 * t;
+    return (2 * t3 - 3 * t2 + 1) * model.knotFlow[k] + (t3 - 2 * t2 + t) * h * model.knotSlope[k] +
+           (-2 * t3 + 3 * t2) * model.knotFlow[k + 1] + (t3 - t2) * h * model.knotSlope[k + 1];
+}
+
+// 三次Hermite插值的导数 d流量/d转速
+double hermiteSlope(const FlowModel &model, size_t k, double x)
+{
+    double h = model.knotRpm[k + 1] - model.knotRpm[k];
+    double t = (x - model.knotRpm[k]) / h;
+    double t2 = t * t;
+    return (6 * t2 - 6 * t) / h * model.knotFlow[k] + (3 * t2 - 4 * t + 1) * model.knotSlope[k] +
+           (-6 * t2 + 6 * t) / h * model.knotFlow[k + 1] + (3 * t2 - 2 * t) * model.knotSlope[k + 1];
 }
 
+// 端区间割线斜率，用于节点范围外的线性外推
+double endSlope(const FlowModel &model, bool upper)
+{
+    size_t k = upper ? model.knotRpm.size() - 2 : 0;
+    return (model.knotFlow[k + 1] - model.knotFlow[k]) / (model.knotRpm[k + 1] - model.knotRpm[k]);
+}
+
+double pchipFlow(const FlowModel &model, double rpm)
+{
+    const auto &x = model.knotRpm;
+    if (rpm <= x.front())
+        return model.knotFlow.front() + (rpm - x.front()) * endSlope(model, false);
+    if (rpm >= x.back())
+        return model.knotFlow.back() + (rpm - x.back()) * endSlope(model, true);
+
+    size_t k = std::upper_bound(x.begin(), x.end(), rpm) - x.begin() - 1;
+    return hermite(model, k, rpm);
+}
+
+double pchipRPM(const FlowModel &model, double flow)
+{
+    const auto &y = model.knotFlow;
+    if (flow <= y.front() || flow >= y.back())
+    {
+        // 与正向相同的线性外推；端区间平坦时取端点转速
+        bool upper = flow >= y.back();
+        double slope = endSlope(model, upper);
+        double x0 = upper ? model.knotRpm.back() : model.knotRpm.front();
+        double y0 = upper ? y.back() : y.front();
+        return slope > 0 ? x0 + (flow - y0) / slope : x0;
+    }
+
+    // 表按平方间距存放，开方后取整即为表项下标，表项间按流量线性插值
+    double last = static_cast<double>(model.inverseRpm.size() - 1);
+    double x = std::sqrt((flow - model.inverseFlow0) / model.inverseSpan) * last;
+    size_t i = std::min(static_cast<size_t>(x), model.inverseRpm.size() - 2);
+    double u0 = i / last;
+    double u1 = (i + 1) / last;
+    double frac = ((flow - model.inverseFlow0) / model.inverseSpan - u0 * u0) / (u1 * u1 - u0 * u0);
+    double rpm = model.inverseRpm[i] + frac * (model.inverseRpm[i + 1] - model.inverseRpm[i]);
+
+    // 以查表值为初值，在流量所在区间上用正向Hermite曲线做一步牛顿修正，使反算与正向求值一致；
+    // 区间按流量确定，避免节点附近查表值落到相邻区间
+    size_t k = std::upper_bound(y.begin(), y.end(), flow) - y.begin() - 1;
+    double lo = model.knotRpm[k];
+    double hi = model.knotRpm[k + 1];
+    rpm = std::min(std::max(rpm, lo), hi);
+    double slope = hermiteSlope(model, k, rpm);
+    if (slope > 0)
+        rpm = std::min(std::max(rpm - (hermite(model, k, rpm) - flow) / slope, lo), hi);
+    return rpm;
+}
+} // namespace
+
 PumpDatabase::PumpDatabase()
 {
-    gsl_set_error_handler(gsl_error_handler);
 }
 
 PumpDatabase::PumpDatabase(const std::string &file_name) : file_name_(file_name)
 {
     loadFromFile(file_name_);
-    gsl_set_error_handler(gsl_error_handler);
 }
 
 // 文件加载函数
 void PumpDatabase::loadFromFile(const std::string &file_name)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     try
     {
         std::ifstream ifs(file_name);
@@ -38,21 +110,31 @@ void PumpDatabase::loadFromFile(const std::string &file_name)
     {
         std::cerr << "Error loading file: " << e.what() << std::endl;
         pumps_.clear();
+        index_.clear();
     }
     file_name_ = file_name;
 }
 
-void PumpDatabase::saveToFile()
+bool PumpDatabase::saveToFile()
 {
-    saveToFile(file_name_);
+    std::string file_name;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_name = file_name_;
+    }
+    return saveToFile(file_name);
 }
 
-void PumpDatabase::saveToFile(const std::string &file_name)
+bool PumpDatabase::saveToFile(const std::string &file_name)
 {
+    std::string backup;
     try
     {
         json j;
-        saveToJson(j);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            saveToJson(j);
+        }
 
         // 备份旧文件
         if (!file_name.empty())
@@ -61,22 +143,34 @@ void PumpDatabase::saveToFile(const std::string &file_name)
             std::stringstream ss;
             ss << file_name << "."
                << std::put_time(std::localtime(&now), "%Y%m%d%H%M%S");
-            std::rename(file_name.c_str(), ss.str().c_str());
+            if (std::rename(file_name.c_str(), ss.str().c_str()) == 0)
+                backup = ss.str();
         }
 
         std::ofstream ofs(file_name);
         ofs << std::setw(4) << j;
+        ofs.close();
+        if (ofs)
+            return true;
+        std::cerr << "Save failed: cannot write " << file_name << std::endl;
     }
     catch (const std::exception &e)
     {
         std::cerr << "Save failed: " << e.what() << std::endl;
     }
+
+    // 写入失败，恢复备份，避免留下残缺的数据文件
+    if (!backup.empty())
+        std::rename(backup.c_str(), file_name.c_str());
+    return false;
 }
 
 // JSON序列化函数
 void PumpDatabase::loadFromJson(const json &j)
 {
     pumps_.clear();
+    index_.clear();
+    index_.reserve(j.size());
     for (const auto &it : j.items())
     {
         const std::string &pump_name = it.key();
@@ -101,14 +195,27 @@ void PumpDatabase::loadFromJson(const json &j)
                 point["flow_rate"].get<double>());
         }
 
-        pumps_.push_back(pd);
+        // 流量模型类型（可选）
+        if (pump_data.value("flow_model", "polynomial") == "pchip")
+            pd.flow_model_type = FlowModel::PCHIP;
+
+        // 脉动剖面（可选）
+        if (pump_data.contains("pulsation_profile"))
+            pd.pulsation_profile = pump_data["pulsation_profile"].get<std::vector<double>>();
+
+        pd.flow_model = fitModel(pd);
+        pumps_.emplace_back();
+        pumps_.back().store(std::make_shared<const PumpData>(std::move(pd)));
+        index_[pump_name] = std::prev(pumps_.end());
     }
 }
 
 void PumpDatabase::saveToJson(json &j) const
 {
-    for (const auto &pd : pumps_)
+    for (const auto &handle : pumps_)
     {
+        PumpSnapshot snapshot = handle.load();
+        const PumpData &pd = *snapshot;
         json &pump_json = j[pd.pump_name];
         pump_json["target_flow_rate_offset"] = pd.target_flow_rate_offset;
 
@@ -129,38 +236,107 @@ void PumpDatabase::saveToJson(json &j) const
                                  {"flow_rate", p.flow_rate}});
         }
         pump_json["rpm_flow_calibrated"] = cal_array;
+
+        if (pd.flow_model_type == FlowModel::PCHIP)
+            pump_json["flow_model"] = "pchip";
+
+        if (!pd.pulsation_profile.empty())
+            pump_json["pulsation_profile"] = pd.pulsation_profile;
     }
 }
 
 // 核心计算函数
 double PumpDatabase::calculateFlowRate(const std::string &pump_name, double rpm)
 {
-    PumpData *pd = findPump(pump_name);
+    PumpSnapshot pd = getPump(pump_name);
     if (!pd)
         return -1.0;
+    return calculateFlowRate(*pd, rpm);
+}
 
-    const auto &points = pd->rpm_flow_points;
-    size_t n = points.size();
+double PumpDatabase::calculateRPM(const std::string &pump_name, double target_flow_rate)
+{
+    PumpSnapshot pd = getPump(pump_name);
+    if (!pd)
+        return -1.0;
+    return calculateRPM(*pd, target_flow_rate);
+}
 
-    if (n < 1)
+double PumpDatabase::calculateFlowRate(const PumpHandle &pump, double rpm)
+{
+    return calculateFlowRate(*pump.load(), rpm);
+}
+
+double PumpDatabase::calculateRPM(const PumpHandle &pump, double target_flow_rate)
+{
+    return calculateRPM(*pump.load(), target_flow_rate);
+}
+
+double PumpDatabase::calculateFlowRate(const PumpData &pump, double rpm)
+{
+    if (!pump.flow_model.valid)
         return -1.0;
+    if (pump.flow_model.type == FlowModel::PCHIP)
+        return pchipFlow(pump.flow_model, rpm);
 
-    try
-    {
-        std::vector<double> coeff;
-        double chisq;
-        polyfit(points, 2, coeff, chisq); // 2阶多项式拟合
+    const double *c = pump.flow_model.flow;
+    return c[0] + rpm * (c[1] + rpm * c[2]);
+}
 
-        double result = 0.0;
-        for (size_t i = 0; i < coeff.size(); ++i)
+double PumpDatabase::calculateRPM(const PumpData &pump, double target_flow_rate)
+{
+    const FlowModel &model = pump.flow_model;
+    if (!model.valid)
+        return -1.0;
+    if (model.type == FlowModel::PCHIP)
+        return pchipRPM(model, target_flow_rate);
+    if (model.rpmLinear)
+        return (target_flow_rate - model.rpm[0]) / model.rpm[1];
+
+    // 一次拟合不可用时降级到线性插值；数据文件按转速降序存放，两种顺序都要处理
+    const auto &points = pump.rpm_flow_points;
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        double lo = std::min(points[i - 1].flow_rate, points[i].flow_rate);
+        double hi = std::max(points[i - 1].flow_rate, points[i].flow_rate);
+        if (lo <= target_flow_rate && target_flow_rate <= hi && lo < hi)
         {
-            result += coeff[i] * std::pow(rpm, i);
+            double x1 = points[i - 1].rpm;
+            double y1 = points[i - 1].flow_rate;
+            double x2 = points[i].rpm;
+            double y2 = points[i].flow_rate;
+
+            // 线性插值公式
+            return x1 + (target_flow_rate - y1) * (x2 - x1) / (y2 - y1);
         }
-        return result;
     }
-    catch (const std::exception &e)
+    return -1.0; // 如果目标流量超出范围
+}
+
+FlowModel PumpDatabase::fitModel(const PumpData &pd)
+{
+    FlowModel model;
+    const auto &points = pd.rpm_flow_points;
+    size_t n = points.size();
+    if (n < 1)
+        return model;
+
+    if (pd.flow_model_type == FlowModel::PCHIP && fitPchip(points, model))
+    {
+        model.valid = true;
+        return model;
+    }
+
+    std::vector<double> coeff;
+    double chisq;
+    if (polyfit(points, 2, coeff, chisq)) // 2阶多项式拟合
     {
-        // 降级到线性回归
+        for (size_t i = 0; i < 3; ++i)
+            model.flow[i] = coeff[i];
+    }
+    else
+    {
+        // 降级到线性回归；所有点转速相同时取流量均值
         double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
         for (const auto &p : points)
         {
@@ -170,94 +346,169 @@ double PumpDatabase::calculateFlowRate(const std::string &pump_name, double rpm)
             sum_xy += p.rpm * p.flow_rate;
         }
 
-        double m = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
-        double b = (sum_y - m * sum_x) / n;
+        double denominator = n * sum_xx - sum_x * sum_x;
+        double m = denominator != 0.0 ? (n * sum_xy - sum_x * sum_y) / denominator : 0.0;
+        model.flow[0] = (sum_y - m * sum_x) / n;
+        model.flow[1] = m;
+    }
 
-        return m * rpm + b;
+    // 反算使用一次拟合，斜率为0时无解，只能插值
+    if (polyfit(points, 1, coeff, chisq) && coeff[1] != 0.0)
+    {
+        model.rpmLinear = true;
+        model.rpm[0] = coeff[0];
+        model.rpm[1] = coeff[1];
     }
+    model.valid = true;
+    return model;
 }
 
-double PumpDatabase::calculateRPM(const std::string &pump_name, double target_flow_rate)
+bool PumpDatabase::fitPchip(const std::vector<FlowRPMPoint> &points, FlowModel &model)
 {
-    PumpData *pd = findPump(pump_name);
-    if (!pd)
-        return -1.0;
-
-    const auto &points = pd->rpm_flow_points;
-    size_t n = points.size();
-
-    if (n < 1)
-        return -1.0;
+    // 按转速升序，相同转速的流量取平均；权重为合并的点数
+    std::vector<FlowRPMPoint> sorted;
+    for (const auto &p : points)
+    {
+        if (std::isfinite(p.rpm) && std::isfinite(p.flow_rate) && p.rpm >= 0)
+            sorted.push_back(p);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const FlowRPMPoint &a, const FlowRPMPoint &b)
+              { return a.rpm < b.rpm; });
 
-    try
+    std::vector<double> x, y, w;
+    for (const auto &p : sorted)
     {
-        // 使用多项式拟合反向计算
-        std::vector<double> coeff;
-        double chisq;
-        polyfit(points, 1, coeff, chisq); // 2阶多项式拟合
+        if (!x.empty() && p.rpm == x.back())
+        {
+            y.back() = (y.back() * w.back() + p.flow_rate) / (w.back() + 1.0);
+            w.back() += 1.0;
+            continue;
+        }
+        x.push_back(p.rpm);
+        y.push_back(p.flow_rate);
+        w.push_back(1.0);
+    }
 
-        // 求解多项式方程 coeff[0] + coeff[1]*rpm + coeff[2]*rpm^2 = target_flow_rate
-        double a = coeff.size() > 2 ? coeff[2] : 0.0;
-        double b = coeff.size() > 1 ? coeff[1] : 0.0;
-        double c = coeff[0] - target_flow_rate;
+    // 停转时无流量：数据不含0转速时补上原点
+    if (!x.empty() && x.front() > 0)
+    {
+        x.insert(x.begin(), 0.0);
+        y.insert(y.begin(), 0.0);
+        w.insert(w.begin(), 1.0);
+    }
+    if (x.size() < 2)
+        return false;
 
-        if (a == 0.0)
+    // 保序回归（合并相邻违序块）：测量噪声造成的流量下降拉平为加权均值，保证单调不减
+    std::vector<double> blockValue, blockWeight;
+    std::vector<size_t> blockSize;
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        blockValue.push_back(y[i]);
+        blockWeight.push_back(w[i]);
+        blockSize.push_back(1);
+        while (blockValue.size() > 1 && blockValue[blockValue.size() - 2] > blockValue.back())
         {
-            // 如果是线性方程
-            if (b == 0.0)
-                throw std::runtime_error("无法计算RPM：无解");
-            return -c / b;
+            size_t b = blockValue.size() - 1;
+            double weight = blockWeight[b - 1] + blockWeight[b];
+            blockValue[b - 1] = (blockValue[b - 1] * blockWeight[b - 1] + blockValue[b] * blockWeight[b]) / weight;
+            blockWeight[b - 1] = weight;
+            blockSize[b - 1] += blockSize[b];
+            blockValue.pop_back();
+            blockWeight.pop_back();
+            blockSize.pop_back();
         }
-
-        // 求解二次方程 ax^2 + bx + c = 0
-        double discriminant = b * b - 4 * a * c;
-        if (discriminant < 0)
-            throw std::runtime_error("无法计算RPM：无实数解");
-
-        double sqrt_discriminant = std::sqrt(discriminant);
-        double rpm1 = (-b + sqrt_discriminant) / (2 * a);
-        double rpm2 = (-b - sqrt_discriminant) / (2 * a);
-
-        // 返回正值解
-        if (rpm1 >= 0 && rpm2 >= 0)
-            return std::min(rpm1, rpm2);
-        else if (rpm1 >= 0)
-            return rpm1;
-        else if (rpm2 >= 0)
-            return rpm2;
-        else
-            throw std::runtime_error("无法计算RPM：无正解");
     }
-    catch (const std::exception &e)
+    y.clear();
+    for (size_t b = 0; b < blockValue.size(); b++)
+        y.insert(y.end(), blockSize[b], blockValue[b]);
+    if (y.back() <= y.front())
+        return false; // 流量不随转速增加，无法反算
+
+    // Fritsch-Carlson单调斜率：内部节点取相邻割线的加权调和平均，端点用三点公式并限幅
+    size_t n = x.size();
+    std::vector<double> h(n - 1), delta(n - 1), d(n);
+    for (size_t k = 0; k + 1 < n; k++)
     {
-        // 降级到线性插值
-        for (size_t i = 1; i < n; ++i)
+        h[k] = x[k + 1] - x[k];
+        delta[k] = (y[k + 1] - y[k]) / h[k];
+    }
+    for (size_t k = 1; k + 1 < n; k++)
+    {
+        if (delta[k - 1] <= 0 || delta[k] <= 0)
         {
-            if (points[i - 1].flow_rate <= target_flow_rate && target_flow_rate <= points[i].flow_rate)
-            {
-                double x1 = points[i - 1].rpm;
-                double y1 = points[i - 1].flow_rate;
-                double x2 = points[i].rpm;
-                double y2 = points[i].flow_rate;
-
-                // 线性插值公式
-                return x1 + (target_flow_rate - y1) * (x2 - x1) / (y2 - y1);
-            }
+            d[k] = 0.0;
+            continue;
         }
-        return -1.0; // 如果目标流量超出范围
+        double w1 = 2 * h[k] + h[k - 1];
+        double w2 = h[k] + 2 * h[k - 1];
+        d[k] = (w1 + w2) / (w1 / delta[k - 1] + w2 / delta[k]);
     }
+    auto endpoint = [](double h0, double h1, double d0, double d1)
+    {
+        double slope = ((2 * h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+        if (slope <= 0 || d0 <= 0)
+            return 0.0;
+        if (d1 <= 0 && slope > 3 * d0)
+            return 3 * d0;
+        return slope;
+    };
+    if (n == 2)
+    {
+        d[0] = d[1] = delta[0];
+    }
+    else
+    {
+        d[0] = endpoint(h[0], h[1], delta[0], delta[1]);
+        d[n - 1] = endpoint(h[n - 2], h[n - 3], delta[n - 2], delta[n - 3]);
+    }
+
+    // 在局部对象中填好节点与反查表后再整体写入model
+    FlowModel fitted;
+    fitted.type = FlowModel::PCHIP;
+    fitted.knotRpm = std::move(x);
+    fitted.knotFlow = std::move(y);
+    fitted.knotSlope = std::move(d);
+
+    // 反查表：对单调的正向曲线二分求逆；流量按平方间距取点，低流量时相对误差不致过大
+    const int size = FlowModel::inverseTableSize;
+    double flow0 = fitted.knotFlow.front();
+    double span = fitted.knotFlow.back() - flow0;
+    fitted.inverseFlow0 = flow0;
+    fitted.inverseSpan = span;
+    fitted.inverseRpm.resize(size);
+    for (int i = 0; i < size; i++)
+    {
+        double u = static_cast<double>(i) / (size - 1);
+        double target = flow0 + span * u * u;
+        double lo = fitted.knotRpm.front();
+        double hi = fitted.knotRpm.back();
+        for (int iter = 0; iter < 60; iter++)
+        {
+            double mid = 0.5 * (lo + hi);
+            if (pchipFlow(fitted, mid) < target)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        fitted.inverseRpm[i] = 0.5 * (lo + hi);
+    }
+    fitted.inverseRpm.front() = fitted.knotRpm.front();
+    fitted.inverseRpm.back() = fitted.knotRpm.back();
+    model = std::move(fitted);
+    return true;
 }
 
 // 多项式拟合实现
-void PumpDatabase::polyfit(
+bool PumpDatabase::polyfit(
     const std::vector<FlowRPMPoint> &points,
     int degree,
     std::vector<double> &coefficients,
     double &chisq)
 {
     size_t n = points.size();
-    if (n <= 0)
-        throw std::invalid_argument("No data points.");
+    if (n < static_cast<size_t>(degree) + 1)
+        return false; // 点数不足以确定系数
 
     // 初始化GSL结构
     gsl_multifit_linear_workspace *workspace = gsl_multifit_linear_alloc(n, degree + 1);
@@ -275,18 +526,23 @@ void PumpDatabase::polyfit(
         gsl_vector_set(Y, i, points[i].flow_rate);
     }
 
-    // 执行拟合
+    // 执行拟合；临时关闭GSL默认的abort处理，由返回值判断失败
     gsl_vector *c = gsl_vector_alloc(degree + 1);
     gsl_matrix *cov = gsl_matrix_alloc(degree + 1, degree + 1);
+    gsl_error_handler_t *handler = gsl_set_error_handler_off();
     int status = gsl_multifit_linear(X, Y, c, cov, &chisq, workspace);
-    if (status != GSL_SUCCESS)
-        throw std::runtime_error("GSL fitting failed.");
+    gsl_set_error_handler(handler);
 
     // 提取系数
-    coefficients.resize(degree + 1);
-    for (size_t i = 0; i < coefficients.size(); i++)
+    bool ok = status == GSL_SUCCESS;
+    if (ok)
     {
-        coefficients[i] = gsl_vector_get(c, i);
+        coefficients.resize(degree + 1);
+        for (size_t i = 0; i < coefficients.size(); i++)
+        {
+            coefficients[i] = gsl_vector_get(c, i);
+            ok = ok && std::isfinite(coefficients[i]);
+        }
     }
 
     // 清理资源
@@ -295,6 +551,7 @@ void PumpDatabase::polyfit(
     gsl_vector_free(Y);
     gsl_vector_free(c);
     gsl_matrix_free(cov);
+    return ok;
 }
 
 // 校准功能
@@ -303,9 +560,12 @@ void PumpDatabase::calibrateFlowRate(
     const std::vector<FlowRPMPoint> &calibration_data,
     std::string calibration_type)
 {
-    PumpData *pd = findPump(pump_name);
-    if (!pd)
+    std::lock_guard<std::mutex> lock(mutex_);
+    PumpHandle *handle = findPump(pump_name);
+    if (!handle)
         return;
+    PumpSnapshot current = handle->load();
+    PumpData updated = *current;
 
     if (calibration_type == "LINEAR")
     {
@@ -315,7 +575,7 @@ void PumpDatabase::calibrateFlowRate(
 
         for (const auto &point : calibration_data)
         {
-            double error = point.flow_rate - calculateFlowRate(pump_name, point.rpm);
+            double error = point.flow_rate - calculateFlowRate(*current, point.rpm);
             sum_x += point.rpm;
             sum_y += error;
             sum_xx += point.rpm * point.rpm;
@@ -325,11 +585,11 @@ void PumpDatabase::calibrateFlowRate(
         double m = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
         double b = (sum_y - m * sum_x) / n;
 
-        pd->rpm_flow_calibrated.clear();
-        for (const auto &p : pd->rpm_flow_points)
+        updated.rpm_flow_calibrated.clear();
+        for (const auto &p : updated.rpm_flow_points)
         {
-            pd->rpm_flow_calibrated.push_back({p.rpm,
-                                               p.flow_rate + m * p.rpm + b});
+            updated.rpm_flow_calibrated.push_back({p.rpm,
+                                                   p.flow_rate + m * p.rpm + b});
         }
     }
     else if (calibration_type == "OFFSET")
@@ -338,65 +598,94 @@ void PumpDatabase::calibrateFlowRate(
         double total_offset = 0.0;
         for (const auto &point : calibration_data)
         {
-            total_offset += (point.flow_rate - calculateFlowRate(pump_name, point.rpm));
+            total_offset += (point.flow_rate - calculateFlowRate(*current, point.rpm));
         }
         double avg_offset = total_offset / calibration_data.size();
 
-        pd->rpm_flow_calibrated.clear();
-        for (const auto &p : pd->rpm_flow_points)
+        updated.rpm_flow_calibrated.clear();
+        for (const auto &p : updated.rpm_flow_points)
         {
-            pd->rpm_flow_calibrated.push_back({p.rpm,
-                                               p.flow_rate + avg_offset});
+            updated.rpm_flow_calibrated.push_back({p.rpm,
+                                                   p.flow_rate + avg_offset});
         }
     }
+    else
+    {
+        return;
+    }
+    updated.flow_model = fitModel(updated);
+    handle->store(std::make_shared<const PumpData>(std::move(updated)));
 }
 
 // 数据管理函数
 bool PumpDatabase::addPump(const PumpData &pump)
 {
-    if (findPump(pump.pump_name))
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.count(pump.pump_name))
         return false; // 名称重复
-    pumps_.push_back(pump);
+    PumpData pd = pump;
+    pd.flow_model = fitModel(pd);
+    pumps_.emplace_back();
+    pumps_.back().store(std::make_shared<const PumpData>(std::move(pd)));
+    index_[pump.pump_name] = std::prev(pumps_.end());
     return true;
 }
 
 bool PumpDatabase::removePump(const std::string &pump_name)
 {
-    auto it = std::remove_if(pumps_.begin(), pumps_.end(),
-                             [&](const PumpData &pd)
-                             { return pd.pump_name == pump_name; });
-    if (it == pumps_.end())
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(pump_name);
+    if (it == index_.end())
         return false;
-    pumps_.erase(it, pumps_.end());
+    pumps_.erase(it->second);
+    index_.erase(it);
     return true;
 }
 
-PumpData *PumpDatabase::findPump(const std::string &pump_name)
+bool PumpDatabase::updatePump(const PumpData &updated_pump)
 {
-    for (auto &pd : pumps_)
-    {
-        if (pd.pump_name == pump_name)
-            return &pd;
-    }
-    return nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    PumpHandle *handle = findPump(updated_pump.pump_name);
+    if (!handle)
+        return false;
+    // 先拟合出完整的新快照再替换，持有旧快照的读者不受影响
+    PumpData updated = updated_pump;
+    updated.flow_model = fitModel(updated);
+    handle->store(std::make_shared<const PumpData>(std::move(updated)));
+    return true;
+}
+
+PumpHandle *PumpDatabase::findPump(const std::string &pump_name)
+{
+    auto it = index_.find(pump_name);
+    return it == index_.end() ? nullptr : &*it->second;
 }
 
 bool PumpDatabase::empty()
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     return pumps_.empty();
 }
 
-const PumpData *PumpDatabase::getPump(const std::string &pump_name)
+PumpSnapshot PumpDatabase::getPump(const std::string &pump_name)
 {
-    for (const auto &pd : pumps_)
-    {
-        if (pd.pump_name == pump_name)
-            return &pd;
-    }
-    return nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    PumpHandle *handle = findPump(pump_name);
+    return handle ? handle->load() : nullptr;
+}
+
+std::vector<PumpSnapshot> PumpDatabase::getPumps()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PumpSnapshot> pumps;
+    pumps.reserve(pumps_.size());
+    for (const auto &handle : pumps_)
+        pumps.push_back(handle.load());
+    return pumps;
 }
 
-const std::vector<PumpData> *PumpDatabase::getPumps()
+const PumpHandle *PumpDatabase::getHandle(const std::string &pump_name)
 {
-    return &pumps_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findPump(pump_name);
 }
@@ -0,0 +1,88 @@
+#include "remaining_time_estimator.hpp"
+#include <algorithm>
+#include <cmath>
+
+RemainingTimeEstimator::RemainingTimeEstimator(std::chrono::seconds window)
+    : tau_(static_cast<double>(std::max<long long>(window.count(), 1)))
+{
+}
+
+void RemainingTimeEstimator::addSample(double level, std::chrono::steady_clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!hasOrigin_)
+    {
+        origin_ = time;
+        hasOrigin_ = true;
+    }
+    double t = std::chrono::duration<double>(time - origin_).count();
+    if (count_ > 0 && t < lastT_)
+    {
+        return; // 乱序样本
+    }
+
+    // 旧样本整体衰减，新样本权重为1
+    if (count_ > 0)
+        sums_.decay(std::exp(-(t - lastT_) / tau_));
+    sums_.add(t, level);
+    lastT_ = t;
+    count_++;
+}
+
+RemainingTimeEstimator::Estimate RemainingTimeEstimator::estimate(std::chrono::steady_clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Estimate result;
+    result.samples = count_;
+    if (count_ < minSamples_)
+    {
+        return result;
+    }
+
+    // 有效时间跨度：均匀采样时跨度S对应的标准差为 S/√12
+    RegressionSums::Fit fit = sums_.fit();
+    if (!fit.valid || std::sqrt(fit.sxx / sums_.w) < minSpan_ / std::sqrt(12.0))
+    {
+        return result;
+    }
+
+    double slope = fit.slope;
+    double tn = std::chrono::duration<double>(now - origin_).count();
+    double level = fit.meanY + slope * (tn - fit.meanT);
+    result.slope = slope;
+    result.level = level;
+    if (slope >= 0 || level <= 0)
+    {
+        // 液位不下降（暂停或检测异常）时无法外推
+        return result;
+    }
+
+    // 残差方差的自由度使用有效样本数 (Σw)²/Σw²
+    double sigma2 = fit.sigma2;
+    double dt = tn - fit.meanT;
+    double varSlope = sigma2 / fit.sxx;
+    double varLevel = sigma2 * (1.0 / sums_.w + dt * dt / fit.sxx);
+    double covLevelSlope = sigma2 * dt / fit.sxx;
+
+    // T = -level/slope，delta方法传播方差
+    double remaining = -level / slope;
+    double dL = -1.0 / slope;
+    double dB = level / (slope * slope);
+    double varT = dL * dL * varLevel + dB * dB * varSlope + 2 * dL * dB * covLevelSlope;
+    double halfWidth = z_ * std::sqrt(std::max(varT, 0.0));
+
+    result.valid = true;
+    result.remaining = remaining;
+    result.remaining_low = std::max(remaining - halfWidth, 0.0);
+    result.remaining_high = remaining + halfWidth;
+    return result;
+}
+
+void RemainingTimeEstimator::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    hasOrigin_ = false;
+    lastT_ = 0.0;
+    count_ = 0;
+    sums_.clear();
+}
@@ -0,0 +1,188 @@
+#include "roi_rectifier.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <vector>
+
+bool RoiRectifier::loadCalibration(const std::string &path)
+{
+    try
+    {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened())
+        {
+            InfusionLogger::error("无法打开相机标定文件: {}", path);
+            return false;
+        }
+
+        cv::Mat cameraMatrix, distCoeffs, planeHomography;
+        int width = 0, height = 0;
+        fs["camera_matrix"] >> cameraMatrix;
+        fs["distortion_coefficients"] >> distCoeffs;
+        fs["image_width"] >> width;
+        fs["image_height"] >> height;
+        fs["plane_homography"] >> planeHomography;
+        if (cameraMatrix.size() != cv::Size(3, 3) || distCoeffs.empty() || width <= 0 || height <= 0)
+        {
+            InfusionLogger::error("相机标定文件缺少有效的内参或图像尺寸: {}", path);
+            return false;
+        }
+        if (!planeHomography.empty() && planeHomography.size() != cv::Size(3, 3))
+        {
+            InfusionLogger::error("相机标定文件中的 plane_homography 不是3x3矩阵: {}", path);
+            return false;
+        }
+
+        cameraMatrix.convertTo(cameraMatrix_, CV_64F);
+        distCoeffs.reshape(1, 1).convertTo(distCoeffs_, CV_64F);
+        if (!planeHomography.empty())
+        {
+            planeHomography.convertTo(planeHomography_, CV_64F);
+        }
+        calibSize_ = cv::Size(width, height);
+        calibrated_ = true;
+        roiChanged_ = true;
+        InfusionLogger::info("相机标定已加载: {} ({}x{}{})", path, width, height,
+                             planeHomography_.empty() ? "" : "，含透视校正");
+        return true;
+    }
+    catch (const cv::Exception &e)
+    {
+        InfusionLogger::error("读取相机标定文件出错: {}", e.what());
+        return false;
+    }
+}
+
+void RoiRectifier::setRoi(const cv::Rect2d &roi)
+{
+    if (roi != roi_)
+    {
+        roi_ = roi;
+        roiChanged_ = true;
+    }
+}
+
+bool RoiRectifier::rectify(const cv::Mat &frame, const cv::Rect2d &frameView, bool rotated, cv::Mat &output)
+{
+    if (frame.empty() || frameView.width <= 0 || frameView.height <= 0)
+    {
+        return false;
+    }
+    if (roiChanged_ || frame.size() != frameSize_ || frameView != frameView_ || rotated != rotated_ || map1_.empty())
+    {
+        if (!rebuildMaps(frame.size(), frameView, rotated))
+        {
+            return false;
+        }
+    }
+    cv::remap(frame, output, map1_, map2_, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    return true;
+}
+
+cv::Point2d RoiRectifier::distort(const cv::Point2d &point) const
+{
+    const double fx = cameraMatrix_.at<double>(0, 0);
+    const double fy = cameraMatrix_.at<double>(1, 1);
+    const double cx = cameraMatrix_.at<double>(0, 2);
+    const double cy = cameraMatrix_.at<double>(1, 2);
+    auto coeff = [this](int i)
+    { return i < distCoeffs_.cols ? distCoeffs_.at<double>(0, i) : 0.0; };
+    const double k1 = coeff(0), k2 = coeff(1), p1 = coeff(2), p2 = coeff(3), k3 = coeff(4);
+
+    // OpenCV针孔模型的径向+切向畸变
+    double x = (point.x - cx) / fx;
+    double y = (point.y - cy) / fy;
+    double r2 = x * x + y * y;
+    double radial = 1 + k1 * r2 + k2 * r2 * r2 + k3 * r2 * r2 * r2;
+    double xd = x * radial + 2 * p1 * x * y + p2 * (r2 + 2 * x * x);
+    double yd = y * radial + p1 * (r2 + 2 * y * y) + 2 * p2 * x * y;
+    return cv::Point2d(fx * xd + cx, fy * yd + cy);
+}
+
+bool RoiRectifier::rebuildMaps(const cv::Size &frameSize, const cv::Rect2d &frameView, bool rotated)
+{
+    const double refW = calibSize_.width;
+    const double refH = calibSize_.height;
+
+    // ROI四角：畸变图像像素 → 去畸变像素 → 瓶体正视平面
+    std::vector<cv::Point2d> corners = {
+        {roi_.x * refW, roi_.y * refH},
+        {(roi_.x + roi_.width) * refW, roi_.y * refH},
+        {(roi_.x + roi_.width) * refW, (roi_.y + roi_.height) * refH},
+        {roi_.x * refW, (roi_.y + roi_.height) * refH}};
+    std::vector<cv::Point2d> plane = corners;
+    if (calibrated_)
+    {
+        // undistortPoints以像素中心为整数坐标
+        for (auto &corner : corners)
+        {
+            corner -= cv::Point2d(0.5, 0.5);
+        }
+        cv::undistortPoints(corners, plane, cameraMatrix_, distCoeffs_, cv::noArray(), cameraMatrix_);
+        for (auto &point : plane)
+        {
+            point += cv::Point2d(0.5, 0.5);
+        }
+    }
+    cv::Mat toImage = cv::Mat::eye(3, 3, CV_64F);
+    if (!planeHomography_.empty())
+    {
+        cv::perspectiveTransform(plane, plane, planeHomography_);
+        toImage = planeHomography_.inv();
+    }
+
+    // 取正视平面内的内接矩形，避免输出中混入ROI以外的区域
+    double left = std::max(plane[0].x, plane[3].x);
+    double right = std::min(plane[1].x, plane[2].x);
+    double top = std::max(plane[0].y, plane[1].y);
+    double bottom = std::min(plane[2].y, plane[3].y);
+    if (right - left < 1.0 || bottom - top < 1.0)
+    {
+        InfusionLogger::error("ROI矫正: 校正后的ROI无效");
+        return false;
+    }
+
+    // 输出尺寸与ROI在本帧中的原始像素数相当，不做放大
+    int outW = std::max(1, cvRound(roi_.width / frameView.width * frameSize.width));
+    int outH = std::max(1, cvRound(roi_.height / frameView.height * frameSize.height));
+
+    cv::Mat mapX(outH, outW, CV_32F);
+    cv::Mat mapY(outH, outW, CV_32F);
+    const double *h = toImage.ptr<double>();
+    for (int v = 0; v < outH; ++v)
+    {
+        float *mx = mapX.ptr<float>(v);
+        float *my = mapY.ptr<float>(v);
+        double py = top + (v + 0.5) / outH * (bottom - top);
+        for (int u = 0; u < outW; ++u)
+        {
+            double px = left + (u + 0.5) / outW * (right - left);
+            // 正视平面 → 去畸变图像（连续坐标）
+            double w = h[6] * px + h[7] * py + h[8];
+            cv::Point2d p((h[0] * px + h[1] * py + h[2]) / w, (h[3] * px + h[4] * py + h[5]) / w);
+            // 去畸变 → 畸变图像（像素中心为整数坐标）
+            if (calibrated_)
+            {
+                p = distort(p - cv::Point2d(0.5, 0.5)) + cv::Point2d(0.5, 0.5);
+            }
+            // 全视场 → 本帧（ISP裁剪、倒置）
+            double fxn = (p.x / refW - frameView.x) / frameView.width * frameSize.width;
+            double fyn = (p.y / refH - frameView.y) / frameView.height * frameSize.height;
+            if (rotated)
+            {
+                fxn = frameSize.width - fxn;
+                fyn = frameSize.height - fyn;
+            }
+            mx[u] = static_cast<float>(fxn - 0.5);
+            my[u] = static_cast<float>(fyn - 0.5);
+        }
+    }
+    cv::convertMaps(mapX, mapY, map1_, map2_, CV_16SC2);
+
+    frameSize_ = frameSize;
+    frameView_ = frameView;
+    rotated_ = rotated;
+    roiChanged_ = false;
+    rebuilds_++;
+    InfusionLogger::info("ROI矫正映射表已重建: {}x{}", outW, outH);
+    return true;
+}
@@ -4,6 +4,10 @@
 #include <nlohmann/json.hpp>
 #include <motor_driver.hpp>
 #include <pump_common.hpp>
+#include "camera_manager.hpp"
+#include "liquid_detector.hpp"
+#include "pump_calibrator.hpp"
+#include <cmath>
 
 using json = nlohmann::json;
 
@@ -11,6 +15,8 @@ using json = nlohmann::json;
 extern MotorDriver *g_motorDriver;
 extern PumpParams g_pumpParams;
 extern InfusionStateMachine *g_stateMachine;
+extern CameraManager *g_cameraManager;
+extern PumpCalibrator *g_pumpCalibrator;
 
 // 设置泵电源状态
 std::string rpc_powerState_fn(const json &params)
@@ -98,7 +104,7 @@ std::string rpc_startPumpState_fn(const json &params)
     }
 
     // 设置目标流量，状态机将负责计算转速和控制电机
-    double flow_rate = abs(params[0].get<double>());
+    double flow_rate = std::abs(params[0].get<double>());
     g_pumpParams.target_flow_rate.store(flow_rate);
 
     // 仅设置状态，不直接操作电机
@@ -251,6 +257,9 @@ std::string rpc_getPumpState_fn(const json &params)
     case ERROR:
         state_str = "ERROR";
         break;
+    case CALIBRATING:
+        state_str = "CALIBRATING";
+        break;
     default:
         state_str = "UNKNOWN";
         break;
@@ -323,6 +332,10 @@ std::string rpc_validateStateTransition_fn(const json &params)
     {
         from_state = ERROR;
     }
+    else if (from_str == "CALIBRATING")
+    {
+        from_state = CALIBRATING;
+    }
     else
     {
         InfusionLogger::error("未知的泵起始状态: {}", from_str);
@@ -364,6 +377,10 @@ std::string rpc_validateStateTransition_fn(const json &params)
     {
         to_state = ERROR;
     }
+    else if (to_str == "CALIBRATING")
+    {
+        to_state = CALIBRATING;
+    }
     else
     {
         InfusionLogger::error("未知的泵目标状态: {}", to_str);
@@ -427,6 +444,9 @@ std::string rpc_getSystemDiagnostics_fn(const json &params)
     case ERROR:
         state_str = "ERROR";
         break;
+    case CALIBRATING:
+        state_str = "CALIBRATING";
+        break;
     default:
         state_str = "UNKNOWN";
         break;
@@ -445,9 +465,83 @@ std::string rpc_getSystemDiagnostics_fn(const json &params)
     diagnostics["target_rpm"] = targetRPM;
     diagnostics["direction"] = direction ? "forward" : "reverse";
     diagnostics["current_speed"] = currentSpeed;
+
+    // 步数里程计
+    MotorDriver::Odometer odometer = g_motorDriver->getOdometer();
+    diagnostics["odometer"] = {{"revolutions", odometer.revolutions},
+                               {"delivered_volume", odometer.volume},
+                               {"vtbi", g_pumpParams.vtbi.load()}};
+
+    // 电机硬件命令合并统计
+    MotorDriver::CommandStats commands = g_motorDriver->getCommandStats();
+    diagnostics["motor_commands"] = {{"applied", commands.applied},
+                                     {"suppressed", commands.suppressed},
+                                     {"syscalls", commands.syscalls},
+                                     {"failed", commands.failed}};
+
+    // 电机控制线程定时抖动
+    MotorDriver::TimingStats timing = g_motorDriver->getTimingStats();
+    auto histogramJson = [](const JitterHistogram::Snapshot &snapshot)
+    {
+        json buckets = json::array();
+        for (int i = 0; i < JitterHistogram::bucketCount; i++)
+        {
+            double bound = JitterHistogram::bucketUpperBound(i);
+            buckets.push_back({{"le_us", bound < 0 ? json("inf") : json(bound)},
+                               {"count", snapshot.counts[i]}});
+        }
+        return json{{"buckets", buckets},
+                    {"samples", snapshot.samples},
+                    {"mean_us", snapshot.mean_us},
+                    {"max_us", snapshot.max_us}};
+    };
+    diagnostics["motor_timing"] = {{"realtime", timing.realtime},
+                                   {"lateness", histogramJson(timing.lateness)},
+                                   {"period", histogramJson(timing.period)}};
     diagnostics["timestamp"] = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count() /
                                                      1000000);
 
+    // 视觉流水线各级队列深度与时延
+    if (g_cameraManager)
+    {
+        json pipeline = json::array();
+        for (const auto &stage : g_cameraManager->getPipelineStats())
+        {
+            pipeline.push_back({{"stage", stage.name},
+                                {"queue_depth", stage.queue_depth},
+                                {"processed", stage.processed},
+                                {"dropped", stage.dropped},
+                                {"latency_ms", stage.latency_ms},
+                                {"wait_ms", stage.wait_ms},
+                                {"frame_age_ms", stage.frame_age_ms}});
+        }
+        diagnostics["camera_pipeline"] = pipeline;
+        diagnostics["roi_map_rebuilds"] = g_cameraManager->getRoiMapRebuilds();
+
+        LevelDetectionStats level = g_cameraManager->getLevelDetectionStats();
+        diagnostics["level_tracking"] = {{"tracked_frames", level.tracked_frames},
+                                         {"full_scans", level.full_scans},
+                                         {"track_losses", level.track_losses},
+                                         {"tracked_ratio", level.tracked_ratio},
+                                         {"tracked_latency_ms", level.tracked_latency_ms},
+                                         {"full_scan_latency_ms", level.full_scan_latency_ms}};
+
+        const LoadShedder &shedder = g_cameraManager->getLoadShedder();
+        diagnostics["load_shedding"] = {{"mode", LoadShedder::modeName(shedder.getMode())},
+                                        {"budget_ms", shedder.getBudget().count()},
+                                        {"shed_frames", shedder.getShedFrames()}};
+
+        CameraManager::DetectorStats detector = g_cameraManager->getDetectorStats();
+        diagnostics["level_detector"] = {{"primary", detector.primary},
+                                         {"shadow", detector.shadow},
+                                         {"shadow_samples", detector.shadow_samples},
+                                         {"shadow_failures", detector.shadow_failures},
+                                         {"primary_latency_ms", detector.primary_latency_ms},
+                                         {"shadow_latency_ms", detector.shadow_latency_ms},
+                                         {"mean_disagreement", detector.mean_disagreement},
+                                         {"max_disagreement", detector.max_disagreement}};
+    }
+
     // 构建响应
     json response_json;
     response_json["diagnostics"] = diagnostics;
@@ -456,6 +550,115 @@ std::string rpc_getSystemDiagnostics_fn(const json &params)
     return response_json.dump();
 }
 
+// 开始现场标定
+// 参数（均可省略）: {"rpms": [...], "bottle_volume": ml, "profile": [[液位%, 容量ml], ...], "max_step_seconds": s}
+// 未给出bottle_volume与profile时，按当前泵参数中的药瓶容量标定
+std::string rpc_startCalibration_fn(const json &params)
+{
+    if (!g_pumpCalibrator)
+    {
+        InfusionLogger::error("输液系统未完全初始化");
+        json error_json;
+        error_json["error"] = "Infusion system not fully initialized";
+        return error_json.dump();
+    }
+
+    std::vector<double> rpms = {60.0, 30.0, 15.0, 7.0, 3.0, 1.0};
+    PumpCalibrator::BottleProfile profile;
+    int maxStepSeconds = 600;
+    try
+    {
+        if (params.is_object())
+        {
+            if (params.contains("rpms"))
+                rpms = params["rpms"].get<std::vector<double>>();
+            if (params.contains("bottle_volume"))
+                profile = PumpCalibrator::BottleProfile::linear(params["bottle_volume"].get<double>());
+            if (params.contains("profile"))
+            {
+                profile.points.clear();
+                for (const auto &point : params["profile"])
+                    profile.points.emplace_back(point.at(0).get<double>(), point.at(1).get<double>());
+            }
+            maxStepSeconds = params.value("max_step_seconds", maxStepSeconds);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        InfusionLogger::error("标定参数解析失败: {}", e.what());
+        json error_json;
+        error_json["error"] = "Invalid parameters";
+        return error_json.dump();
+    }
+
+    if (!g_pumpCalibrator->start(rpms, profile, std::chrono::seconds(maxStepSeconds)))
+    {
+        json error_json;
+        error_json["error"] = "Calibration could not be started";
+        return error_json.dump();
+    }
+
+    json response_json;
+    response_json["params"] = params;
+    response_json["result"] = "ok";
+    return response_json.dump();
+}
+
+// 获取标定进度
+std::string rpc_getCalibrationStatus_fn(const json &params)
+{
+    if (!g_pumpCalibrator)
+    {
+        InfusionLogger::error("输液系统未完全初始化");
+        json error_json;
+        error_json["error"] = "Infusion system not fully initialized";
+        return error_json.dump();
+    }
+
+    PumpCalibrator::Status status = g_pumpCalibrator->getStatus();
+    json steps = json::array();
+    for (const auto &step : status.steps)
+    {
+        steps.push_back({{"rpm", step.rpm},
+                         {"flow_rate", step.flow_rate},
+                         {"flow_stderr", step.flow_stderr},
+                         {"duration", step.duration},
+                         {"samples", step.samples},
+                         {"valid", step.valid}});
+    }
+
+    json response_json;
+    response_json["calibration"] = {{"phase", status.phase},
+                                    {"message", status.message},
+                                    {"current_step", status.current_step},
+                                    {"total_steps", status.total_steps},
+                                    {"steps", steps},
+                                    {"fit_rms_error", status.fit_rms_error}};
+    response_json["params"] = params;
+    response_json["result"] = "ok";
+    return response_json.dump();
+}
+
+// 取消标定
+std::string rpc_cancelCalibration_fn(const json &params)
+{
+    if (!g_pumpCalibrator)
+    {
+        InfusionLogger::error("输液系统未完全初始化");
+        json error_json;
+        error_json["error"] = "Infusion system not fully initialized";
+        return error_json.dump();
+    }
+
+    g_pumpCalibrator->cancel();
+    InfusionLogger::info("已请求取消标定");
+
+    json response_json;
+    response_json["params"] = params;
+    response_json["result"] = "ok";
+    return response_json.dump();
+}
+
 // 静态注册器，用于注册RPC函数
 static FunctionRegisterer reg_setPumpPower("setPumpPower", rpc_powerState_fn);
 static FunctionRegisterer reg_startPump("startPump", rpc_startPumpState_fn);
@@ -464,11 +667,16 @@ static FunctionRegisterer reg_emergencyStop("emergencyStop", rpc_emergencyStop_f
 static FunctionRegisterer reg_getPumpState("getPumpState", rpc_getPumpState_fn);
 static FunctionRegisterer reg_validateStateTransition("validateStateTransition", rpc_validateStateTransition_fn);
 static FunctionRegisterer reg_getSystemDiagnostics("getSystemDiagnostics", rpc_getSystemDiagnostics_fn);
+static FunctionRegisterer reg_startCalibration("startCalibration", rpc_startCalibration_fn);
+static FunctionRegisterer reg_getCalibrationStatus("getCalibrationStatus", rpc_getCalibrationStatus_fn);
+static FunctionRegisterer reg_cancelCalibration("cancelCalibration", rpc_cancelCalibration_fn);
 
 // 全局变量定义
 MotorDriver *g_motorDriver = nullptr;
 PumpParams g_pumpParams;
 InfusionStateMachine *g_stateMachine = nullptr;
+CameraManager *g_cameraManager = nullptr;
+PumpCalibrator *g_pumpCalibrator = nullptr;
 
 std::map<std::string, RpcFunction> &get_registry()
 {
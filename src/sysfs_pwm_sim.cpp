@@ -0,0 +1,234 @@
+// sysfs PWM电机后端仿真：在伪造的/sys/class/pwm目录树上运行MotorDriver与MotorBackend_SysfsPwm，
+// 检查新导出通道的初始化、变频时周期与占空比的写入顺序，以及各转速下写入的周期
+// 链接时以 -Wl,--wrap=pwrite 截获属性写入，按内核规则拒绝非法配置；GPIO由本文件中的空实现代替
+#include "logger.hpp"
+#include "motor_driver.hpp"
+#include "motor_hal/motor_sysfs_pwm.hpp"
+#include <gpiod.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+// GPIO空实现：方向与细分引脚的写入总是成功
+static char fakeChip;
+static char fakeLines[64];
+
+gpiod_chip *gpiod_chip_open_by_name(const char *)
+{
+    return reinterpret_cast<gpiod_chip *>(&fakeChip);
+}
+
+void gpiod_chip_close(gpiod_chip *)
+{
+}
+
+gpiod_line *gpiod_chip_get_line(gpiod_chip *, unsigned int offset)
+{
+    return offset < sizeof(fakeLines) ? reinterpret_cast<gpiod_line *>(&fakeLines[offset]) : nullptr;
+}
+
+int gpiod_line_request_bulk_output(gpiod_line_bulk *, const char *, const int *)
+{
+    return 0;
+}
+
+int gpiod_line_set_value_bulk(gpiod_line_bulk *, const int *)
+{
+    return 0;
+}
+
+// 伪内核：跟踪通道的周期与占空比，拒绝占空比大于周期、周期为0时的任何配置
+static const int channel = 3;
+static long long kernelPeriod = 0;
+static long long kernelDuty = 0;
+static atomic<long> attributeWrites{0};
+static atomic<long> rejectedOrder{0}; // 占空比大于周期
+static atomic<long> rejectedZero{0};  // 周期为0时写入
+
+extern "C" ssize_t __real_pwrite(int fd, const void *buffer, size_t length, off_t offset);
+
+extern "C" ssize_t __wrap_pwrite(int fd, const void *buffer, size_t length, off_t offset)
+{
+    char link[512];
+    string proc = "/proc/self/fd/" + to_string(fd);
+    ssize_t size = readlink(proc.c_str(), link, sizeof(link) - 1);
+    link[size > 0 ? size : 0] = '\0';
+    string path(link);
+    string channelDir = "/pwm" + to_string(channel) + "/";
+    if (path.find(channelDir) == string::npos)
+        return __real_pwrite(fd, buffer, length, offset);
+
+    long long value = atoll(string(static_cast<const char *>(buffer), length).c_str());
+    attributeWrites++;
+    if (path.find("/period") != string::npos)
+    {
+        if (value == 0 || value < kernelDuty)
+        {
+            rejectedOrder++;
+            errno = EINVAL;
+            return -1;
+        }
+        kernelPeriod = value;
+    }
+    else if (kernelPeriod == 0)
+    {
+        rejectedZero++;
+        errno = EINVAL;
+        return -1;
+    }
+    else if (path.find("/duty_cycle") != string::npos)
+    {
+        if (value > kernelPeriod)
+        {
+            rejectedOrder++;
+            errno = EINVAL;
+            return -1;
+        }
+        kernelDuty = value;
+    }
+    return __real_pwrite(fd, buffer, length, offset);
+}
+
+static void writeText(const string &path, const string &text)
+{
+    ofstream file(path);
+    file << text;
+}
+
+static long long readValue(const string &path)
+{
+    ifstream file(path);
+    long long value = -1;
+    file >> value;
+    return value;
+}
+
+static void showHelp(const char *programName)
+{
+    cout << "用法: " << programName << " [--writes=N]" << endl;
+    cout << "  --writes=N    随机变速次数（默认: 2000）" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int writes = 2000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.find("--writes=") == 0)
+        {
+            writes = max(1, atoi(arg.substr(9).c_str()));
+        }
+        else
+        {
+            showHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    InfusionLogger::init("sysfs_pwm_sim.log", InfusionLogger::ERROR, 1048576, 1, true, false);
+
+    // 伪造的PWM芯片目录，通道目录在写入export后才出现，属性初始为0（与内核新导出的通道一致）
+    char root[] = "/tmp/sysfs_pwm_sim.XXXXXX";
+    if (!mkdtemp(root))
+    {
+        cerr << "无法创建临时目录: " << strerror(errno) << endl;
+        return 1;
+    }
+    string chip = string(root) + "/pwmchip0";
+    string channelPath = chip + "/pwm" + to_string(channel);
+    mkdir(chip.c_str(), 0755);
+    writeText(chip + "/export", "");
+    writeText(chip + "/unexport", "");
+    thread kernel([&]
+                  {
+                      for (int i = 0; i < 200; ++i)
+                      {
+                          if (readValue(chip + "/export") == channel)
+                          {
+                              mkdir(channelPath.c_str(), 0755);
+                              writeText(channelPath + "/period", "0\n");
+                              writeText(channelPath + "/duty_cycle", "0\n");
+                              writeText(channelPath + "/enable", "0\n");
+                              return;
+                          }
+                          this_thread::sleep_for(chrono::milliseconds(5));
+                      } });
+
+    const int microPins[3] = {16, 17, 20};
+    PumpState pumpState;
+    bool ok;
+    {
+        // 驱动与后端在清理目录树前析构，关闭输出并取消导出
+        auto backend = make_shared<MotorHAL::MotorBackend_SysfsPwm>("gpiochip4", 27, microPins, chip, channel);
+        MotorDriver motor(backend, pumpState);
+        bool initialized = motor.initialize();
+        kernel.join();
+        cout << "新导出通道初始化: " << (initialized ? "成功" : "失败") << endl;
+        ok = initialized;
+
+        // 各转速下的周期、占空比与使能，换算回转速与目标比较
+        cout << fixed;
+        for (double rpm : {0.06, 0.1, 0.35, 0.6, 7.0, 56.2, 150.0, 20.0, 0.06})
+        {
+            motor.setSpeed(rpm);
+            long long period = readValue(channelPath + "/period");
+            long long duty = readValue(channelPath + "/duty_cycle");
+            long long enable = readValue(channelPath + "/enable");
+            int microstep = motor.getMicrostep();
+            double actual = period > 0 ? 1e9 / period * 60.0 / (200.0 * microstep) : 0.0;
+            double error = (actual - rpm) / rpm;
+            cout << setprecision(2) << setw(6) << rpm << " RPM: 周期 " << period << " ns 占空比 " << duty
+                 << " ns 使能 " << enable << " 细分 " << microstep << " -> " << setprecision(6) << actual
+                 << " RPM（误差 " << showpos << setprecision(5) << error * 100 << noshowpos << "%）" << endl;
+            ok = ok && enable == 1 && duty == period / 2 && abs(error) < 1e-4;
+        }
+
+        // 随机变速（含停止），覆盖周期变长、变短与停止后重新起步的各种顺序
+        mt19937 rng(11);
+        uniform_real_distribution<double> speed(0.05, 150.0);
+        long before = attributeWrites;
+        for (int i = 0; i < writes; ++i)
+        {
+            motor.setSpeed(i % 10 == 9 ? 0.0 : speed(rng));
+        }
+        cout << "随机变速 " << writes << " 次: 属性写入 " << attributeWrites - before << " 次" << endl;
+
+        motor.setSpeed(0);
+        long long enable = readValue(channelPath + "/enable");
+        cout << "停止后使能 " << enable << "；被拒绝的写入: 占空比大于周期 " << rejectedOrder << " 次，周期为0时写入 "
+             << rejectedZero << " 次" << endl;
+        MotorDriver::CommandStats stats = motor.getCommandStats();
+        cout << "命令 下发 " << stats.applied << " 失败 " << stats.failed << endl;
+        ok = ok && enable == 0 && rejectedOrder == 0 && rejectedZero == 0 && stats.failed == 0;
+    }
+
+    // 清理伪造的目录树
+    for (const char *name : {"/period", "/duty_cycle", "/enable"})
+    {
+        unlink((channelPath + name).c_str());
+    }
+    rmdir(channelPath.c_str());
+    unlink((chip + "/export").c_str());
+    unlink((chip + "/unexport").c_str());
+    rmdir(chip.c_str());
+    rmdir(root);
+
+    cout << (ok ? "通过" : "失败") << endl;
+    return ok ? 0 : 1;
+}
@@ -28,8 +28,13 @@ public:
     bool startVideo();
     bool getVideoFrame(cv::Mat &frame, unsigned int timeout);
     void stopVideo();
+    //Stops streaming but keeps the configuration, buffers and AE/AWB state so
+    //that resumeVideo() converges within a few frames.
+    bool pauseVideo();
+    bool resumeVideo();
 
     //Applies new zoom options. Before invoking this func modify options->roi.
+    //Safe to call while video is running; the ISP crop follows on the next request.
     void ApplyZoomOptions();
 
 protected:
@@ -45,6 +50,7 @@ protected:
     uint8_t *framebuffer;
     std::mutex mtx;
     bool camerastarted;
+    bool videopaused;
 };
 
 }
@@ -105,6 +105,9 @@ public:
 
     void ApplyRoiSettings();
 
+	// Smallest raw sensor mode that is at least min_width x min_height (null if none).
+	Size SelectSensorMode(unsigned int min_width, unsigned int min_height) const;
+
 	Msg Wait();
 	void PostMessage(MsgType &t, MsgPayload &p);
 
@@ -58,6 +58,8 @@ public:
 	gain=0.0f;
 	ev=0.0f;
 	roi_x=roi_y=roi_width=roi_height=0;
+	sensor_mode_auto=false;
+	sensor_mode_width=sensor_mode_height=0;
 	awb_gain_r=awb_gain_b=0;
         denoise="auto";
         verbose=false;
@@ -87,6 +89,10 @@ public:
 	bool rawfull;
 	libcamera::Transform transform;
 	float roi_x, roi_y, roi_width, roi_height;
+	// Sensor mode for video: either explicit (sensor_mode_width/height) or, when
+	// sensor_mode_auto is set, the smallest mode that still covers video_width/height.
+	bool sensor_mode_auto;
+	unsigned int sensor_mode_width, sensor_mode_height;
 	float shutter;
 	float gain;
 	float ev;
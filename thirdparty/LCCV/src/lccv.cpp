@@ -29,6 +29,7 @@ PiCamera::PiCamera(uint32_t id) {
     frameready.store(false, std::memory_order_release);;
     framebuffer=nullptr;
     camerastarted=false;
+    videopaused=false;
 }
 
 PiCamera::~PiCamera() {}
@@ -118,6 +119,12 @@ bool PiCamera::startVideo()
 
 void PiCamera::stopVideo()
 {
+    if(videopaused){
+        videopaused=false;
+        app->Teardown();
+        app->CloseCamera();
+        return;
+    }
     if(!running)return;
 
     running.store(false, std::memory_order_release);;
@@ -134,6 +141,42 @@ void PiCamera::stopVideo()
     frameready.store(false, std::memory_order_release);;
 }
 
+bool PiCamera::pauseVideo()
+{
+    if(!running.load(std::memory_order_acquire))return false;
+
+    running.store(false, std::memory_order_release);
+
+    void *status;
+    int ret = pthread_join(videothread, &status);
+    if(ret<0)
+        std::cerr<<"Error joining thread"<<std::endl;
+
+    //Only stop the requests; the IPA keeps its AGC/AWB state for the next start.
+    app->StopCamera();
+    frameready.store(false, std::memory_order_release);
+    videopaused=true;
+    return true;
+}
+
+bool PiCamera::resumeVideo()
+{
+    if(!videopaused)return false;
+
+    frameready.store(false, std::memory_order_release);
+    app->StartCamera();
+    videopaused=false;
+
+    running.store(true, std::memory_order_release);
+    int ret = pthread_create(&videothread, NULL, &videoThreadFunc, this);
+    if (ret != 0) {
+        std::cerr<<"Error restarting video thread";
+        running.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
 bool PiCamera::getVideoFrame(cv::Mat &frame, unsigned int timeout)
 {
     if(!running.load(std::memory_order_acquire))return false;
@@ -98,7 +98,7 @@ void LibcameraApp::ConfigureStill(unsigned int flags)
     if (options_->photo_height)
         configuration_->at(0).size.height = options_->photo_height;
 
-//    configuration_->transform = options_->transform;
+	configuration_->orientation = libcamera::Orientation::Rotate0 * options_->transform;
 
 	//if (have_raw_stream && !options_->rawfull)
 	{
@@ -122,7 +122,15 @@ void LibcameraApp::ConfigureViewfinder()
     if (options_->verbose)
         std::cerr << "Configuring viewfinder..." << std::endl;
 
+    // A raw stream of the requested size forces the pipeline to pick that sensor mode,
+    // so a small binned mode keeps the readout and ISP load down.
+    Size sensor_mode(options_->sensor_mode_width, options_->sensor_mode_height);
+    if (options_->sensor_mode_auto)
+        sensor_mode = SelectSensorMode(options_->video_width, options_->video_height);
+
     StreamRoles stream_roles = { StreamRole::Viewfinder };
+    if (!sensor_mode.isNull())
+        stream_roles.push_back(StreamRole::Raw);
     configuration_ = camera_->generateConfiguration(stream_roles);
     if (!configuration_)
         throw std::runtime_error("failed to generate viewfinder configuration");
@@ -132,18 +140,50 @@ void LibcameraApp::ConfigureViewfinder()
     configuration_->at(0).size.width = options_->video_width;
     configuration_->at(0).size.height = options_->video_height;
     configuration_->at(0).bufferCount = 4;
+    if (!sensor_mode.isNull())
+    {
+        configuration_->at(1).size = sensor_mode;
+        configuration_->at(1).bufferCount = configuration_->at(0).bufferCount;
+        if (options_->verbose)
+            std::cerr << "Using sensor mode " << sensor_mode.toString() << std::endl;
+    }
 
-//    configuration_->transform = options_->transform;
+    // Let the ISP do the flip/rotation instead of the application rotating every frame.
+    configuration_->orientation = libcamera::Orientation::Rotate0 * options_->transform;
 
     configureDenoise(options_->denoise == "auto" ? "cdn_off" : options_->denoise);
     setupCapture();
 
     streams_["viewfinder"] = configuration_->at(0).stream();
+    if (!sensor_mode.isNull())
+        streams_["raw"] = configuration_->at(1).stream();
 
     if (options_->verbose)
         std::cerr << "Viewfinder setup complete" << std::endl;
 }
 
+libcamera::Size LibcameraApp::SelectSensorMode(unsigned int min_width, unsigned int min_height) const
+{
+	std::unique_ptr<CameraConfiguration> raw_config = camera_->generateConfiguration({ StreamRole::Raw });
+	if (!raw_config)
+		return Size();
+
+	// Every raw format lists the same mode sizes, so just take the smallest area that fits.
+	Size best;
+	const libcamera::StreamFormats &formats = raw_config->at(0).formats();
+	for (const PixelFormat &format : formats.pixelformats())
+	{
+		for (const Size &size : formats.sizes(format))
+		{
+			if (size.width < min_width || size.height < min_height)
+				continue;
+			if (best.isNull() || size.width * size.height < best.width * best.height)
+				best = size;
+		}
+	}
+	return best;
+}
+
 void LibcameraApp::Teardown()
 {
 	if (options_->verbose && !options_->help)
@@ -279,7 +319,9 @@ void LibcameraApp::StopCamera()
 }
 
 void LibcameraApp::ApplyRoiSettings(){
-    if (!controls_.get(controls::ScalerCrop) && options_->roi_width != 0 && options_->roi_height != 0)
+    // May be called while streaming: the crop is picked up by the next queued request,
+    // and replaces any crop that has not been sent yet.
+    if (camera_ && options_->roi_width != 0 && options_->roi_height != 0)
     {
         Rectangle sensor_area = *camera_->properties().get(properties::ScalerCropMaximum);
         int x = options_->roi_x * sensor_area.width;
@@ -290,6 +332,7 @@ void LibcameraApp::ApplyRoiSettings(){
         crop.translateBy(sensor_area.topLeft());
         if (options_->verbose)
             std::cerr << "Using crop " << crop.toString() << std::endl;
+        std::lock_guard<std::mutex> lock(control_mutex_);
         controls_.set(controls::ScalerCrop, crop);
     }
 }